@@ -127,6 +127,112 @@ int32 *hashSha1(const void *data, uint32 len, void *dest) {
 
 QString AlphaSignature;
 
+// Delta packages format, duplicated in update_checker.cpp.
+const quint32 kDeltaPackageFlag = 0x40000000U;
+const quint8 kDeltaFileFull = 0;
+const quint8 kDeltaFilePatch = 1;
+const quint8 kDeltaEnd = 0;
+const quint8 kDeltaCopy = 1;
+const quint8 kDeltaInsert = 2;
+const int kDeltaBlockSize = 64;
+const int kDeltaMaxCandidates = 8;
+
+QString DeltaBasePath;
+int DeltaBaseVersion = 0;
+
+uint32 deltaBlockHash(const uchar *data) {
+	uint32 a = 0, b = 0;
+	for (int i = 0; i < kDeltaBlockSize; ++i) {
+		a += data[i];
+		b += a;
+	}
+	return (a & 0xFFFF) | (b << 16);
+}
+
+// Produces a list of operations that build "target" from "base":
+// copy (offset, length) from the base file or insert literal bytes.
+// Blocks of the base file are indexed by a rolling checksum,
+// matches found in the target are then extended in both directions.
+QByteArray ComputeDelta(const QByteArray &base, const QByteArray &target) {
+	QByteArray result;
+	QDataStream stream(&result, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	uchar baseSha1[20];
+	hashSha1(base.constData(), base.size(), baseSha1);
+	stream << QByteArray((const char*)baseSha1, 20) << quint32(base.size());
+
+	const uchar *from = (const uchar*)base.constData();
+	const uchar *to = (const uchar*)target.constData();
+	const int fromSize = base.size(), toSize = target.size();
+
+	QMultiHash<uint32, int> blocks;
+	for (int offset = 0; offset + kDeltaBlockSize <= fromSize; offset += kDeltaBlockSize) {
+		blocks.insert(deltaBlockHash(from + offset), offset);
+	}
+
+	int literalStart = 0, position = 0;
+	uint32 a = 0, b = 0;
+	bool hashValid = false;
+	const auto flushLiteral = [&](int till) {
+		if (till > literalStart) {
+			stream << kDeltaInsert << QByteArray((const char*)(to + literalStart), till - literalStart);
+		}
+	};
+	while (position + kDeltaBlockSize <= toSize) {
+		if (!hashValid) {
+			a = b = 0;
+			for (int i = 0; i < kDeltaBlockSize; ++i) {
+				a += to[position + i];
+				b += a;
+			}
+			hashValid = true;
+		}
+		const uint32 hash = (a & 0xFFFF) | (b << 16);
+
+		int bestOffset = -1, bestLength = 0, candidates = 0;
+		for (auto i = blocks.constFind(hash); i != blocks.cend() && i.key() == hash && candidates < kDeltaMaxCandidates; ++i, ++candidates) {
+			const int offset = i.value();
+			if (memcmp(from + offset, to + position, kDeltaBlockSize)) {
+				continue;
+			}
+			int length = kDeltaBlockSize;
+			while (offset + length < fromSize && position + length < toSize && from[offset + length] == to[position + length]) {
+				++length;
+			}
+			if (length > bestLength) {
+				bestLength = length;
+				bestOffset = offset;
+			}
+		}
+		if (bestOffset < 0) {
+			// Roll the checksum one byte forward.
+			const uint32 out = to[position];
+			a -= out;
+			b -= out * kDeltaBlockSize;
+			if (position + kDeltaBlockSize < toSize) {
+				a += to[position + kDeltaBlockSize];
+				b += a;
+			}
+			++position;
+			continue;
+		}
+		while (bestOffset > 0 && position > literalStart && from[bestOffset - 1] == to[position - 1]) {
+			--bestOffset;
+			--position;
+			++bestLength;
+		}
+		flushLiteral(position);
+		stream << kDeltaCopy << quint32(bestOffset) << quint32(bestLength);
+		position += bestLength;
+		literalStart = position;
+		hashValid = false;
+	}
+	flushLiteral(toSize);
+	stream << kDeltaEnd;
+	return result;
+}
+
 int writeAlphaKey() {
 	if (!AlphaVersion) {
 		return 0;
@@ -164,6 +270,10 @@ int main(int argc, char *argv[])
 			version = QString(argv[i + 1]).toInt();
 		} else if (string("-beta") == argv[i]) {
 			BetaChannel = true;
+		} else if (string("-delta") == argv[i] && i + 1 < argc) {
+			DeltaBasePath = QFileInfo(workDir + QString(argv[i + 1])).canonicalFilePath() + "/";
+		} else if (string("-from") == argv[i] && i + 1 < argc) {
+			DeltaBaseVersion = QString(argv[i + 1]).toInt();
 		} else if (string("-alphakey") == argv[i]) {
 			OnlyAlphaKey = true;
 		} else if (string("-alpha") == argv[i] && i + 1 < argc) {
@@ -190,10 +300,14 @@ int main(int argc, char *argv[])
 #elif defined Q_OS_MAC
 		cout << "Usage: Packer.app -path {file} -version {version} OR Packer.app -path {dir} -version {version}\n";
 #else
-		cout << "Usage: Packer -path {file} -version {version} OR Packer -path {dir} -version {version}\n";
+		cout << "Usage: Packer -path {file} -version {version} OR Packer -path {dir} -version {version} [-delta {previous dir} -from {previous version}]\n";
 #endif
 		return -1;
 	}
+	if (!DeltaBasePath.isEmpty() && (AlphaVersion || DeltaBaseVersion <= 1016 || DeltaBaseVersion >= version)) {
+		cout << "Delta packages require -from {previous version} and can't be alpha, usage: Packer -path {dir} -version {version} -delta {previous dir} -from {previous version}\n";
+		return -1;
+	}
 
 	bool hasDirs = true;
 	while (hasDirs) {
@@ -241,7 +355,11 @@ int main(int argc, char *argv[])
 			stream << quint32(version);
 		}
 
-		stream << quint32(files.size());
+		if (DeltaBasePath.isEmpty()) {
+			stream << quint32(files.size());
+		} else {
+			stream << (quint32(files.size()) | kDeltaPackageFlag) << quint32(DeltaBaseVersion);
+		}
 		cout << "Found " << files.size() << " file" << (files.size() == 1 ? "" : "s") << "..\n";
 		for (QFileInfoList::iterator i = files.begin(); i != files.end(); ++i) {
 			QFileInfo info(*i);
@@ -255,7 +373,20 @@ int main(int argc, char *argv[])
 				return -1;
 			}
 			QByteArray inner = f.readAll();
-			stream << name << quint32(inner.size()) << inner;
+			stream << name << quint32(inner.size());
+			if (!DeltaBasePath.isEmpty()) {
+				QFile baseFile(DeltaBasePath + name);
+				if (baseFile.open(QIODevice::ReadOnly)) {
+					QByteArray delta = ComputeDelta(baseFile.readAll(), inner);
+					cout << "Delta for " << name.toUtf8().constData() << ": " << delta.size() << "\n";
+					stream << kDeltaFilePatch << delta;
+				} else {
+					cout << "No base for " << name.toUtf8().constData() << ", packing full file\n";
+					stream << kDeltaFileFull << inner;
+				}
+			} else {
+				stream << inner;
+			}
 #ifdef Q_OS_UNIX
 			stream << (QFileInfo(fullName).isExecutable() ? true : false);
 #endif
@@ -480,6 +611,8 @@ int main(int argc, char *argv[])
 #endif
 	if (AlphaVersion) {
 		outName += "_" + AlphaSignature;
+	} else if (!DeltaBasePath.isEmpty()) {
+		outName += "_from" + QString::number(DeltaBaseVersion);
 	}
 	QFile out(outName);
 	if (!out.open(QIODevice::WriteOnly)) {
@@ -22,6 +22,7 @@ constexpr auto kCancelTypingActionTimeout = crl::time(5000);
 constexpr auto kSendMySpeakingInterval = 3 * crl::time(1000);
 constexpr auto kSendMyTypingInterval = 5 * crl::time(1000);
 constexpr auto kSendTypingsToOfflineFor = TimeId(30);
+constexpr auto kSendActionSendDelay = crl::time(20);
 
 } // namespace
 
@@ -141,7 +142,7 @@ void SendProgressManager::send(const Key &key, int progress) {
 		action
 	)).done([=](const MTPBool &result, mtpRequestId requestId) {
 		done(result, requestId);
-	}).send();
+	}).afterDelay(kSendActionSendDelay).send();
 	_requests.emplace(key, requestId);
 
 	if (key.type == Type::Typing) {
@@ -57,6 +57,13 @@ constexpr auto kNoUpdatesTimeout = 60 * 1000;
 // If nothing is received in 1 min when was a sleepmode we ping.
 constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 
+// Apply getDifference in steps not longer than that, to keep UI responsive.
+constexpr auto kDifferenceApplyStep = crl::time(10);
+constexpr auto kDifferenceApplyChunk = 16;
+
+// Received and not yet applied getDifference slices count limit.
+constexpr auto kMaxDifferenceSlicesQueued = 2;
+
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
 	FromNotLoaded = 1,
@@ -215,6 +222,7 @@ Updates::Updates(not_null<Main::Session*> session)
 , _byPtsTimer([=] { getDifferenceByPts(); })
 , _bySeqTimer([=] { getDifference(); })
 , _byMinChannelTimer([=] { getDifference(); })
+, _differenceApplyTimer([=] { applyDifferenceSlices(); })
 , _failDifferenceTimer([=] { getDifferenceAfterFail(); })
 , _idleFinishTimer([=] { checkIdleFinish(); }) {
 	_ptsWaiter.setRequesting(true);
@@ -229,10 +237,28 @@ Updates::Updates(not_null<Main::Session*> session)
 		mtpNewSessionCreated();
 	}, _lifetime);
 
-	api().request(MTPupdates_GetState(
-	)).done([=](const MTPupdates_State &result) {
-		stateDone(result);
-	}).send();
+	if (const auto state = session->account().takeDormantState()) {
+		// Continue from the state a dormant account has seen, so that
+		// the messages received since then will be notified.
+		const auto &data = state->c_updates_state();
+		setState(
+			data.vpts().v,
+			data.vdate().v,
+			data.vqts().v,
+			data.vseq().v);
+		_ptsWaiter.setRequesting(false);
+		getDifference();
+
+		crl::on_main(session, [=] {
+			session->api().requestDialogs();
+			updateOnline();
+		});
+	} else {
+		api().request(MTPupdates_GetState(
+		)).done([=](const MTPupdates_State &result) {
+			stateDone(result);
+		}).send();
+	}
 
 	using namespace rpl::mappers;
 	base::ObservableViewer(
@@ -438,6 +464,15 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	switch (result.type()) {
 	case mtpc_updates_differenceEmpty: {
 		auto &d = result.c_updates_differenceEmpty();
+		_differenceIncomplete = false;
+		if (!_differenceSlices.empty()) {
+			auto slice = DifferenceSlice();
+			slice.date = d.vdate().v;
+			slice.seq = d.vseq().v;
+			slice.last = true;
+			_differenceSlices.push_back(std::move(slice));
+			break;
+		}
 		setState(_ptsWaiter.current(), d.vdate().v, _updatesQts, d.vseq().v);
 
 		_lastUpdateTime = crl::now();
@@ -447,31 +482,168 @@ void Updates::differenceDone(const MTPupdates_Difference &result) {
 	} break;
 	case mtpc_updates_differenceSlice: {
 		auto &d = result.c_updates_differenceSlice();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		auto &s = d.vintermediate_state().c_updates_state();
-		setState(s.vpts().v, s.vdate().v, s.vqts().v, s.vseq().v);
-
-		_ptsWaiter.setRequesting(false);
-
-		MTP_LOG(0, ("getDifference "
-			"{ good - after a slice of difference was received }%1"
-			).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
-		getDifference();
+		queueDifference(
+			d.vusers(),
+			d.vchats(),
+			d.vnew_messages(),
+			d.vother_updates(),
+			d.vintermediate_state(),
+			false);
+		requestDifferenceAhead();
 	} break;
 	case mtpc_updates_difference: {
 		auto &d = result.c_updates_difference();
-		feedDifference(d.vusers(), d.vchats(), d.vnew_messages(), d.vother_updates());
-
-		stateDone(d.vstate());
+		queueDifference(
+			d.vusers(),
+			d.vchats(),
+			d.vnew_messages(),
+			d.vother_updates(),
+			d.vstate(),
+			true);
 	} break;
 	case mtpc_updates_differenceTooLong: {
 		auto &d = result.c_updates_differenceTooLong();
+		_differenceIncomplete = false;
 		LOG(("API Error: updates.differenceTooLong is not supported by Telegram Desktop!"));
 	} break;
 	};
 }
 
+void Updates::queueDifference(
+		const MTPVector<MTPUser> &users,
+		const MTPVector<MTPChat> &chats,
+		const MTPVector<MTPMessage> &msgs,
+		const MTPVector<MTPUpdate> &other,
+		const MTPupdates_State &state,
+		bool last) {
+	const auto &data = state.c_updates_state();
+	auto slice = DifferenceSlice{
+		.users = users,
+		.chats = chats,
+		.messages = msgs.v,
+		.updates = other.v,
+		.pts = data.vpts().v,
+		.date = data.vdate().v,
+		.qts = data.vqts().v,
+		.seq = data.vseq().v,
+		.last = last,
+		.full = last,
+	};
+
+	// Same order as in Data::Session::processMessages.
+	ranges::stable_sort(slice.messages, std::less<>(), [](
+			const MTPMessage &message) {
+		return uint32(IdFromMessage(message));
+	});
+
+	// Same order as in feedUpdateVector.
+	ranges::stable_sort(slice.updates, std::less<>(), [](
+			const MTPUpdate &update) {
+		return (update.type() == mtpc_updateGroupCallParticipants) ? 0 : 1;
+	});
+
+	_differenceIncomplete = !last;
+	_differenceSlices.push_back(std::move(slice));
+	if (!_differenceApplyTimer.isActive()) {
+		applyDifferenceSlices();
+	}
+}
+
+void Updates::requestDifferenceAhead() {
+	// The queue may already be empty if the slices were applied at once,
+	// requestDifference() continues from the committed state then.
+	if (_differenceRequestId
+		|| _getDifferenceTimeAfterFail
+		|| !_differenceIncomplete
+		|| _differenceSlices.size() >= kMaxDifferenceSlicesQueued) {
+		return;
+	}
+	MTP_LOG(0, ("getDifference "
+		"{ good - after a slice of difference was received }%1"
+		).arg(_session->mtp().isTestMode() ? " TESTMODE" : ""));
+	requestDifference();
+}
+
+void Updates::applyDifferenceSlices() {
+	const auto till = crl::now() + kDifferenceApplyStep;
+	while (!_differenceSlices.empty()) {
+		auto &slice = _differenceSlices.front();
+		if (!applyDifferenceSlice(slice, till)) {
+			_differenceApplyTimer.callOnce(0);
+			return;
+		}
+		const auto applied = std::move(slice);
+		_differenceSlices.pop_front();
+		differenceSliceApplied(applied);
+		requestDifferenceAhead();
+
+		if (crl::now() >= till && !_differenceSlices.empty()) {
+			_differenceApplyTimer.callOnce(0);
+			return;
+		}
+	}
+}
+
+bool Updates::applyDifferenceSlice(DifferenceSlice &slice, crl::time till) {
+	auto &owner = session().data();
+	if (!slice.started) {
+		slice.started = true;
+		Core::App().checkAutoLock();
+		owner.processUsers(slice.users);
+		owner.processChats(slice.chats);
+		for (const auto &update : std::as_const(slice.updates)) {
+			if (update.type() == mtpc_updateMessageID) {
+				feedUpdate(update);
+			}
+		}
+	}
+	const auto timeout = [&] {
+		if (crl::now() < till) {
+			return false;
+		}
+		owner.sendHistoryChangeNotifications();
+		return true;
+	};
+	while (slice.messagesApplied < slice.messages.size()) {
+		const auto count = std::min(
+			int(slice.messages.size()) - slice.messagesApplied,
+			kDifferenceApplyChunk);
+		owner.processMessages(
+			slice.messages.mid(slice.messagesApplied, count),
+			NewMessageType::Unread);
+		slice.messagesApplied += count;
+		if (timeout()) {
+			return false;
+		}
+	}
+	while (slice.updatesApplied < slice.updates.size()) {
+		const auto &update = slice.updates[slice.updatesApplied++];
+		if (update.type() != mtpc_updateMessageID) {
+			feedUpdate(update);
+		}
+		if (!(slice.updatesApplied % kDifferenceApplyChunk) && timeout()) {
+			return false;
+		}
+	}
+	owner.sendHistoryChangeNotifications();
+	return true;
+}
+
+void Updates::differenceSliceApplied(const DifferenceSlice &slice) {
+	setState(slice.pts, slice.date, slice.qts, slice.seq);
+	if (!slice.last) {
+		return;
+	}
+	_lastUpdateTime = crl::now();
+	_noUpdatesTimer.callOnce(kNoUpdatesTimeout);
+	_ptsWaiter.setRequesting(false);
+
+	if (slice.full) {
+		session().api().requestDialogs();
+		updateOnline();
+	}
+}
+
 bool Updates::whenGetDiffChanged(
 		ChannelData *channel,
 		int32 ms,
@@ -557,19 +729,6 @@ bool Updates::updateAndApply(int32 pts, int32 ptsCount) {
 	return _ptsWaiter.updateAndApply(nullptr, pts, ptsCount);
 }
 
-void Updates::feedDifference(
-		const MTPVector<MTPUser> &users,
-		const MTPVector<MTPChat> &chats,
-		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other) {
-	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, true);
-}
-
 void Updates::differenceFail(const MTP::Error &error) {
 	LOG(("RPC Error in getDifference: %1 %2: %3").arg(
 		QString::number(error.code()),
@@ -610,6 +769,10 @@ void Updates::getDifferenceAfterFail() {
 	if (_getDifferenceTimeAfterFail) {
 		if (_getDifferenceTimeAfterFail > now) {
 			wait = _getDifferenceTimeAfterFail - now;
+		} else if (_differenceIncomplete) {
+			// Continue after the received slices, applied or not.
+			_getDifferenceTimeAfterFail = 0;
+			requestDifferenceAhead();
 		} else {
 			_ptsWaiter.setRequesting(false);
 			MTP_LOG(0, ("getDifference "
@@ -649,15 +812,30 @@ void Updates::getDifference() {
 
 	_ptsWaiter.setRequesting(true);
 
-	api().request(MTPupdates_GetDifference(
+	requestDifference();
+}
+
+void Updates::requestDifference() {
+	Expects(!_differenceRequestId);
+
+	// Received slices are applied later, continue right after them.
+	const auto last = _differenceSlices.empty()
+		? nullptr
+		: &_differenceSlices.back();
+	const auto pts = (last && last->pts) ? last->pts : _ptsWaiter.current();
+	const auto date = last ? last->date : _updatesDate;
+	const auto qts = (last && last->qts) ? last->qts : _updatesQts;
+	_differenceRequestId = api().request(MTPupdates_GetDifference(
 		MTP_flags(0),
-		MTP_int(_ptsWaiter.current()),
+		MTP_int(pts),
 		MTPint(),
-		MTP_int(_updatesDate),
-		MTP_int(_updatesQts)
+		MTP_int(date),
+		MTP_int(qts)
 	)).done([=](const MTPupdates_Difference &result) {
+		_differenceRequestId = 0;
 		differenceDone(result);
 	}).fail([=](const MTP::Error &error) {
+		_differenceRequestId = 0;
 		differenceFail(error);
 	}).send();
 }
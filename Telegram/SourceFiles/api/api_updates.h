@@ -71,6 +71,23 @@ private:
 		rpl::lifetime lifetime;
 	};
 
+	// A received part of getDifference, applied in time-limited steps.
+	struct DifferenceSlice {
+		MTPVector<MTPUser> users;
+		MTPVector<MTPChat> chats;
+		QVector<MTPMessage> messages;
+		QVector<MTPUpdate> updates;
+		int32 pts = 0;
+		int32 date = 0;
+		int32 qts = 0;
+		int32 seq = 0;
+		int messagesApplied = 0;
+		int updatesApplied = 0;
+		bool started = false;
+		bool last = false;
+		bool full = false;
+	};
+
 	void channelRangeDifferenceSend(
 		not_null<ChannelData*> channel,
 		MsgRange range,
@@ -91,13 +108,20 @@ private:
 	void getChannelDifference(
 		not_null<ChannelData*> channel,
 		ChannelDifferenceRequest from = ChannelDifferenceRequest::Unknown);
+	void requestDifference();
+	void requestDifferenceAhead();
 	void differenceDone(const MTPupdates_Difference &result);
 	void differenceFail(const MTP::Error &error);
-	void feedDifference(
+	void queueDifference(
 		const MTPVector<MTPUser> &users,
 		const MTPVector<MTPChat> &chats,
 		const MTPVector<MTPMessage> &msgs,
-		const MTPVector<MTPUpdate> &other);
+		const MTPVector<MTPUpdate> &other,
+		const MTPupdates_State &state,
+		bool last);
+	void applyDifferenceSlices();
+	bool applyDifferenceSlice(DifferenceSlice &slice, crl::time till);
+	void differenceSliceApplied(const DifferenceSlice &slice);
 	void stateDone(const MTPupdates_State &state);
 	void setState(int32 pts, int32 date, int32 qts, int32 seq);
 	void channelDifferenceDone(
@@ -153,6 +177,11 @@ private:
 
 	base::Timer _byMinChannelTimer;
 
+	mtpRequestId _differenceRequestId = 0;
+	std::deque<DifferenceSlice> _differenceSlices;
+	bool _differenceIncomplete = false;
+	base::Timer _differenceApplyTimer;
+
 	// growing timeout for getDifference calls, if it fails
 	crl::time _failDifferenceTimeout = 1;
 	// growing timeout for getChannelDifference calls, if it fails
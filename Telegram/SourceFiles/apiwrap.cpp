@@ -104,6 +104,7 @@ constexpr auto kUnreadMentionsNextRequestLimit = 100;
 constexpr auto kSharedMediaLimit = 100;
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderQueueWorkersLimit = 4;
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(60 * 60 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
@@ -187,7 +188,12 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	std::clamp(
+		QThread::idealThreadCount() - 1,
+		1,
+		kFileLoaderQueueWorkersLimit)))
 , _topPromotionTimer([=] { refreshTopPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); })
 , _authorizations(std::make_unique<Api::Authorizations>(this))
@@ -1343,13 +1349,13 @@ void ApiWrap::markMediaRead(
 			MTP_vector<MTPint>(markedIds)
 		)).done([=](const MTPmessages_AffectedMessages &result) {
 			applyAffectedMessages(result);
-		}).send();
+		}).afterDelay(kSmallDelayMs).send();
 	}
 	for (const auto &channelIds : channelMarkedIds) {
 		request(MTPchannels_ReadMessageContents(
 			channelIds.first->inputChannel,
 			MTP_vector<MTPint>(channelIds.second)
-		)).send();
+		)).afterDelay(kSmallDelayMs).send();
 	}
 }
 
@@ -1367,13 +1373,13 @@ void ApiWrap::markMediaRead(not_null<HistoryItem*> item) {
 		request(MTPchannels_ReadMessageContents(
 			channel->inputChannel,
 			ids
-		)).send();
+		)).afterDelay(kSmallDelayMs).send();
 	} else {
 		request(MTPmessages_ReadMessageContents(
 			ids
 		)).done([=](const MTPmessages_AffectedMessages &result) {
 			applyAffectedMessages(result);
-		}).send();
+		}).afterDelay(kSmallDelayMs).send();
 	}
 }
 
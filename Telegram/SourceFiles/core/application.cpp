@@ -21,6 +21,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
 #include "core/ui_integration.h"
+#include "core/core_startup_pipeline.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "chat_helpers/stickers_emoji_image_loader.h"
 #include "base/platform/base_platform_info.h"
@@ -173,101 +174,134 @@ Application::~Application() {
 }
 
 void Application::run() {
-	style::internal::StartFonts();
+	using Thread = StartupPipeline::Thread;
 
-	ThirdParty::start();
-	Global::start();
-	refreshGlobalProxy(); // Depends on Global::start().
-
-	// Depends on OpenSSL on macOS, so on ThirdParty::start().
-	// Depends on notifications settings.
-	_notifications = std::make_unique<Window::Notifications::System>();
-
-	startLocalStorage();
-	ValidateScale();
-
-	if (Local::oldSettingsVersion() < AppVersion) {
-		psNewVersion();
-	}
+	auto pipeline = StartupPipeline();
+	pipeline.add(u"fonts"_q, [] {
+		style::internal::StartFonts();
+	});
 
-	if (cAutoStart() && !Platform::AutostartSupported()) {
-		cSetAutoStart(false);
-	}
+	// Create mime database, so it won't be slow later.
+	pipeline.add(u"mime"_q, {}, Thread::Background, [] {
+		QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	});
 
-	if (cLaunchMode() == LaunchModeAutoStart && !cAutoStart()) {
-		psAutoStart(false, true);
-		App::quit();
-		return;
-	}
+	// Opening OpenAL backends may take a while, don't block the UI on it.
+	pipeline.add(u"audio_devices"_q, {}, Thread::Background, [] {
+		Media::Audio::PrepareDevices();
+	});
 
-	_translator = std::make_unique<Lang::Translator>();
-	QCoreApplication::instance()->installTranslator(_translator.get());
+	pipeline.add(u"third_party"_q, [=] {
+		ThirdParty::start();
+		Global::start();
+		refreshGlobalProxy(); // Depends on Global::start().
 
-	style::startManager(cScale());
-	Ui::InitTextOptions();
-	Ui::Emoji::Init();
-	startEmojiImageLoader();
-	startSystemDarkModeViewer();
-	Media::Player::start(_audio.get());
+		// Depends on OpenSSL on macOS, so on ThirdParty::start().
+		// Depends on notifications settings.
+		_notifications = std::make_unique<Window::Notifications::System>();
+	});
+	pipeline.add(u"local_storage"_q, [&] {
+		startLocalStorage();
+		ValidateScale();
 
-	style::ShortAnimationPlaying(
-	) | rpl::start_with_next([=](bool playing) {
-		if (playing) {
-			MTP::details::pause();
-		} else {
-			MTP::details::unpause();
+		if (Local::oldSettingsVersion() < AppVersion) {
+			psNewVersion();
 		}
-	}, _lifetime);
-
-	DEBUG_LOG(("Application Info: inited..."));
 
-	cChangeTimeFormat(QLocale::system().timeFormat(QLocale::ShortFormat));
+		if (cAutoStart() && !Platform::AutostartSupported()) {
+			cSetAutoStart(false);
+		}
 
-	DEBUG_LOG(("Application Info: starting app..."));
+		if (cLaunchMode() == LaunchModeAutoStart && !cAutoStart()) {
+			psAutoStart(false, true);
+			pipeline.stop();
+		}
+	});
+	pipeline.add(u"lang"_q, [=] {
+		_translator = std::make_unique<Lang::Translator>();
+		QCoreApplication::instance()->installTranslator(_translator.get());
+	});
+	pipeline.add(u"style"_q, [] {
+		style::startManager(cScale());
+		Ui::InitTextOptions();
+	});
+	pipeline.add(u"emoji"_q, [=] {
+		Ui::Emoji::Init();
+		startEmojiImageLoader();
+		startSystemDarkModeViewer();
+	});
+	pipeline.add(u"audio"_q, { u"audio_devices"_q }, Thread::Main, [=] {
+		Media::Player::start(_audio.get());
+
+		style::ShortAnimationPlaying(
+		) | rpl::start_with_next([=](bool playing) {
+			if (playing) {
+				MTP::details::pause();
+			} else {
+				MTP::details::unpause();
+			}
+		}, _lifetime);
 
-	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+		DEBUG_LOG(("Application Info: inited..."));
 
-	_window = std::make_unique<Window::Controller>();
+		cChangeTimeFormat(QLocale::system().timeFormat(QLocale::ShortFormat));
+	});
+	pipeline.add(u"window"_q, [=] {
+		DEBUG_LOG(("Application Info: starting app..."));
 
-	_domain->activeChanges(
-	) | rpl::start_with_next([=](not_null<Main::Account*> account) {
-		_window->showAccount(account);
-	}, _window->widget()->lifetime());
+		_window = std::make_unique<Window::Controller>();
 
-	QCoreApplication::instance()->installEventFilter(this);
+		_domain->activeChanges(
+		) | rpl::start_with_next([=](not_null<Main::Account*> account) {
+			_window->showAccount(account);
+		}, _window->widget()->lifetime());
 
-	appDeactivatedValue(
-	) | rpl::start_with_next([=](bool deactivated) {
-		if (deactivated) {
-			handleAppDeactivated();
-		} else {
-			handleAppActivated();
-		}
-	}, _lifetime);
+		QCoreApplication::instance()->installEventFilter(this);
 
-	DEBUG_LOG(("Application Info: window created..."));
+		appDeactivatedValue(
+		) | rpl::start_with_next([=](bool deactivated) {
+			if (deactivated) {
+				handleAppDeactivated();
+			} else {
+				handleAppActivated();
+			}
+		}, _lifetime);
 
-	// Depend on activeWindow() for now :(
-	startShortcuts();
-	App::initMedia();
-	startDomain();
+		DEBUG_LOG(("Application Info: window created..."));
 
-	_window->widget()->show();
+		// Depend on activeWindow() for now :(
+		startShortcuts();
+	});
+	pipeline.add(u"media"_q, [] {
+		App::initMedia();
+	});
+	pipeline.add(u"domain"_q, [=] {
+		startDomain();
+	});
+	pipeline.add(u"show"_q, [=] {
+		_window->widget()->show();
+	});
+	pipeline.add(u"media_view"_q, [=] {
+		const auto currentGeometry = _window->widget()->geometry();
+		_mediaView = std::make_unique<Media::View::OverlayWidget>();
+		_window->widget()->setGeometry(currentGeometry);
+	});
+	pipeline.add(u"first_show"_q, [=] {
+		DEBUG_LOG(("Application Info: showing."));
+		_window->finishFirstShow();
 
-	const auto currentGeometry = _window->widget()->geometry();
-	_mediaView = std::make_unique<Media::View::OverlayWidget>();
-	_window->widget()->setGeometry(currentGeometry);
+		if (!_window->locked() && cStartToSettings()) {
+			_window->showSettings();
+		}
 
-	DEBUG_LOG(("Application Info: showing."));
-	_window->finishFirstShow();
+		_window->updateIsActiveFocus();
+	});
 
-	if (!_window->locked() && cStartToSettings()) {
-		_window->showSettings();
+	if (!pipeline.run()) {
+		App::quit();
+		return;
 	}
 
-	_window->updateIsActiveFocus();
-
 	for (const auto &error : Shortcuts::Errors()) {
 		LOG(("Shortcuts Error: %1").arg(error));
 	}
@@ -731,7 +765,7 @@ bool Application::offerLegacyLangPackSwitch() const {
 
 bool Application::canApplyLangPackWithoutRestart() const {
 	for (const auto &[index, account] : _domain->accounts()) {
-		if (account->sessionExists()) {
+		if (account->authorized()) {
 			return false;
 		}
 	}
@@ -866,7 +900,7 @@ rpl::producer<bool> Application::passcodeLockValue() const {
 
 bool Application::someSessionExists() const {
 	for (const auto &[index, account] : _domain->accounts()) {
-		if (account->sessionExists()) {
+		if (account->authorized()) {
 			return true;
 		}
 	}
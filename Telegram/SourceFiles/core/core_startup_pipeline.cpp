@@ -0,0 +1,144 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_startup_pipeline.h"
+
+#include "core/crash_reports.h"
+
+namespace Core {
+
+StartupPipeline::StartupPipeline() = default;
+
+StartupPipeline::~StartupPipeline() {
+	// Background stages capture pointers to the stages, wait for them.
+	for (const auto &stage : _stages) {
+		waitFor(*stage);
+	}
+}
+
+void StartupPipeline::add(
+		const QString &id,
+		std::vector<QString> after,
+		Thread thread,
+		Fn<void()> method) {
+	Expects(indexOf(id) < 0);
+	Expects(method != nullptr);
+
+	auto stage = std::make_unique<Stage>();
+	stage->id = id;
+	stage->thread = thread;
+	stage->method = std::move(method);
+	for (const auto &dependency : after) {
+		// Stages should be added in the dependency order.
+		const auto index = indexOf(dependency);
+		Assert(index >= 0);
+
+		// Background stages are launched from the main thread only.
+		Assert(thread == Thread::Main
+			|| _stages[index]->thread == Thread::Main);
+
+		stage->after.push_back(index);
+	}
+	_stages.push_back(std::move(stage));
+}
+
+void StartupPipeline::add(const QString &id, Fn<void()> method) {
+	add(id, {}, Thread::Main, std::move(method));
+}
+
+void StartupPipeline::stop() {
+	_stopped = true;
+}
+
+int StartupPipeline::indexOf(const QString &id) const {
+	const auto i = ranges::find(_stages, id, &Stage::id);
+	return (i != end(_stages)) ? int(i - begin(_stages)) : -1;
+}
+
+bool StartupPipeline::ready(const Stage &stage) const {
+	return ranges::all_of(stage.after, [&](int index) {
+		return _stages[index]->done;
+	});
+}
+
+void StartupPipeline::launchReadyBackground() {
+	for (const auto &stage : _stages) {
+		if (stage->thread != Thread::Background
+			|| stage->launched
+			|| !ready(*stage)) {
+			continue;
+		}
+		stage->launched = true;
+		crl::async([=, raw = stage.get()] {
+			raw->started = crl::now();
+			raw->method();
+			raw->duration = crl::now() - raw->started;
+			raw->finished.release();
+		});
+	}
+}
+
+void StartupPipeline::runMain(Stage &stage) {
+	for (const auto index : stage.after) {
+		waitFor(*_stages[index]);
+	}
+	stage.launched = true;
+	stage.started = crl::now();
+	stage.method();
+	stage.duration = crl::now() - stage.started;
+	stage.done = true;
+}
+
+void StartupPipeline::waitFor(Stage &stage) {
+	if (stage.done || !stage.launched) {
+		return;
+	}
+	Assert(stage.thread == Thread::Background);
+	stage.finished.acquire();
+	stage.done = true;
+}
+
+bool StartupPipeline::run() {
+	_started = crl::now();
+	for (const auto &stage : _stages) {
+		launchReadyBackground();
+		if (_stopped) {
+			break;
+		} else if (stage->thread == Thread::Main) {
+			runMain(*stage);
+		}
+	}
+	for (const auto &stage : _stages) {
+		waitFor(*stage);
+	}
+	_finished = crl::now();
+
+	const auto result = trace();
+	LOG(("Startup Trace: %1").arg(result));
+	CrashReports::SetAnnotation("Startup", result);
+
+	return !_stopped;
+}
+
+QString StartupPipeline::trace() const {
+	auto list = QStringList();
+	for (const auto &stage : _stages) {
+		if (!stage->done) {
+			list.push_back(stage->id + ":skipped");
+			continue;
+		}
+		list.push_back(u"%1:%2+%3%4"_q
+			.arg(stage->id)
+			.arg(stage->started - _started)
+			.arg(stage->duration)
+			.arg(stage->thread == Thread::Background ? "*" : ""));
+	}
+	list.push_back(u"total:%1"_q.arg(_finished - _started));
+	return list.join(' ');
+}
+
+} // namespace Core
@@ -0,0 +1,68 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+
+// Application startup expressed as a list of stages with dependencies.
+//
+// Main stages run on the main thread in the order they were added.
+// Background stages run in crl::async as soon as all the main stages
+// they depend on are finished, main stages that depend on them wait.
+class StartupPipeline final {
+public:
+	enum class Thread {
+		Main,
+		Background,
+	};
+
+	StartupPipeline();
+	~StartupPipeline();
+
+	void add(
+		const QString &id,
+		std::vector<QString> after,
+		Thread thread,
+		Fn<void()> method);
+	void add(const QString &id, Fn<void()> method);
+
+	// Skips all the remaining main stages, may be called from a main stage.
+	void stop();
+
+	// Returns false if the pipeline was stopped.
+	bool run();
+
+	[[nodiscard]] QString trace() const;
+
+private:
+	struct Stage {
+		QString id;
+		std::vector<int> after;
+		Thread thread = Thread::Main;
+		Fn<void()> method;
+		crl::semaphore finished;
+		crl::time started = 0;
+		crl::time duration = 0;
+		bool launched = false;
+		bool done = false;
+	};
+
+	[[nodiscard]] int indexOf(const QString &id) const;
+	[[nodiscard]] bool ready(const Stage &stage) const;
+	void launchReadyBackground();
+	void runMain(Stage &stage);
+	void waitFor(Stage &stage);
+
+	std::vector<std::unique_ptr<Stage>> _stages;
+	crl::time _started = 0;
+	crl::time _finished = 0;
+	bool _stopped = false;
+
+};
+
+} // namespace Core
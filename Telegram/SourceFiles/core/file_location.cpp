@@ -11,12 +11,208 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "logs.h"
 
 #include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QPointer>
 
 namespace Core {
 namespace {
 
 const auto kInMediaCacheLocation = u"*media_cache*"_q;
 
+// Cached file states are re-read in the background after that timeout.
+constexpr auto kRevalidateTimeout = 30 * crl::time(1000);
+constexpr auto kMaxCachedStates = 16 * 1024;
+constexpr auto kMaxWatchedDirectories = 64;
+constexpr auto kMaxWatchedFiles = 1024;
+
+struct FileState {
+	bool readable = false;
+	qint64 size = 0;
+	QDateTime modified;
+};
+
+[[nodiscard]] FileState ReadFileState(const QString &path) {
+	const auto info = QFileInfo(path);
+	auto result = FileState();
+	result.readable = info.isReadable();
+	if (result.readable) {
+		result.size = info.size();
+		result.modified = info.lastModified();
+	}
+	return result;
+}
+
+// Keeps the last known states of the checked files, so that checks from
+// paint handlers don't wait for the filesystem. States are re-read in
+// the background, by timeout or when the watcher (inotify on Linux)
+// reports a change in the file folder. The directory watch doesn't
+// report changes inside a file, so the file itself is watched as well.
+// Files that could not be watched are checked synchronously.
+class FileStates final {
+public:
+	[[nodiscard]] FileState get(const QString &path);
+	void set(const QString &path, const FileState &state);
+
+private:
+	struct Entry {
+		FileState state;
+		crl::time checked = 0;
+		bool revalidating = false;
+		bool watched = false;
+	};
+
+	void store(const QString &path, const FileState &state);
+	void revalidate(std::vector<QString> paths);
+	void revalidateDirectory(const QString &directory);
+	void fileChanged(const QString &path);
+	void watch(const QString &path);
+	[[nodiscard]] bool createWatcher();
+
+	QMutex _mutex;
+	QHash<QString, Entry> _entries;
+	QPointer<QFileSystemWatcher> _watcher;
+	base::flat_set<QString> _watchedDirectories;
+	base::flat_set<QString> _watchedFiles;
+
+};
+
+FileState FileStates::get(const QString &path) {
+	const auto now = crl::now();
+	{
+		QMutexLocker lock(&_mutex);
+		const auto i = _entries.find(path);
+		if (i != _entries.end() && i->watched) {
+			const auto result = i->state;
+			if (!i->revalidating && now - i->checked >= kRevalidateTimeout) {
+				i->revalidating = true;
+				lock.unlock();
+				revalidate({ path });
+			}
+			return result;
+		}
+	}
+	const auto result = ReadFileState(path);
+	set(path, result);
+	return result;
+}
+
+void FileStates::set(const QString &path, const FileState &state) {
+	store(path, state);
+	crl::on_main([=] {
+		watch(path);
+	});
+}
+
+void FileStates::store(const QString &path, const FileState &state) {
+	QMutexLocker lock(&_mutex);
+	if (_entries.size() >= kMaxCachedStates && !_entries.contains(path)) {
+		_entries.clear();
+	}
+	auto &entry = _entries[path];
+	entry.state = state;
+	entry.checked = crl::now();
+	entry.revalidating = false;
+}
+
+void FileStates::revalidate(std::vector<QString> paths) {
+	crl::async([=, paths = std::move(paths)] {
+		for (const auto &path : paths) {
+			const auto state = ReadFileState(path);
+
+			QMutexLocker lock(&_mutex);
+			const auto i = _entries.find(path);
+			if (i != _entries.end()) {
+				i->state = state;
+				i->checked = crl::now();
+				i->revalidating = false;
+			}
+		}
+	});
+}
+
+void FileStates::revalidateDirectory(const QString &directory) {
+	const auto prefix = directory.endsWith('/') ? directory : (directory + '/');
+	auto paths = std::vector<QString>();
+	{
+		QMutexLocker lock(&_mutex);
+		for (auto i = _entries.begin(); i != _entries.end(); ++i) {
+			if (!i->revalidating && i.key().startsWith(prefix)) {
+				i->revalidating = true;
+				paths.push_back(i.key());
+			}
+		}
+	}
+	if (!paths.empty()) {
+		revalidate(std::move(paths));
+	}
+}
+
+void FileStates::fileChanged(const QString &path) {
+	// The watch may be gone if the file was removed or replaced,
+	// so the next check reads the file and watches it again.
+	_watchedFiles.remove(path);
+	_watcher->removePath(path);
+
+	QMutexLocker lock(&_mutex);
+	_entries.remove(path);
+}
+
+bool FileStates::createWatcher() {
+	if (_watcher) {
+		return true;
+	}
+	const auto application = QCoreApplication::instance();
+	if (!application) {
+		return false;
+	}
+	// Owned by the application, so it is destroyed before it.
+	_watcher = new QFileSystemWatcher(application);
+	QObject::connect(
+		_watcher,
+		&QFileSystemWatcher::directoryChanged,
+		_watcher,
+		[=](const QString &changed) { revalidateDirectory(changed); });
+	QObject::connect(
+		_watcher,
+		&QFileSystemWatcher::fileChanged,
+		_watcher,
+		[=](const QString &changed) { fileChanged(changed); });
+	return true;
+}
+
+void FileStates::watch(const QString &path) {
+	if (!createWatcher()) {
+		return;
+	}
+	const auto directory = QFileInfo(path).absolutePath();
+	if (!_watchedDirectories.contains(directory)) {
+		if (_watchedDirectories.size() >= kMaxWatchedDirectories
+			|| !_watcher->addPath(directory)) {
+			return;
+		}
+		_watchedDirectories.emplace(directory);
+	}
+	if (!_watchedFiles.contains(path)) {
+		if (_watchedFiles.size() >= kMaxWatchedFiles
+			|| !_watcher->addPath(path)) {
+			return;
+		}
+		_watchedFiles.emplace(path);
+	}
+
+	QMutexLocker lock(&_mutex);
+	const auto i = _entries.find(path);
+	if (i != _entries.end()) {
+		i->watched = true;
+	}
+}
+
+[[nodiscard]] FileStates &States() {
+	static auto result = FileStates();
+	return result;
+}
+
 } // namespace
 
 ReadAccessEnabler::ReadAccessEnabler(const Platform::FileBookmark *bookmark)
@@ -50,6 +246,9 @@ FileLocation::FileLocation(const QString &name) : fname(name) {
 			} else {
 				modified = f.lastModified();
 				size = qint32(s);
+				if (!_bookmark) {
+					States().set(name, { f.isReadable(), s, modified });
+				}
 			}
 		} else {
 			fname = QString();
@@ -73,10 +272,11 @@ bool FileLocation::check() const {
 		const_cast<FileLocation*>(this)->_bookmark = nullptr;
 	}
 
-	QFileInfo f(name());
-	if (!f.isReadable()) return false;
+	// Bookmarked files may be accessed only while the access is enabled.
+	const auto f = _bookmark ? ReadFileState(name()) : States().get(name());
+	if (!f.readable) return false;
 
-	quint64 s = f.size();
+	quint64 s = f.size;
 	if (s > INT_MAX) {
 		DEBUG_LOG(("File location check: Wrong size %1").arg(s));
 		return false;
@@ -86,7 +286,7 @@ bool FileLocation::check() const {
 		DEBUG_LOG(("File location check: Wrong size %1 when should be %2").arg(s).arg(size));
 		return false;
 	}
-	auto realModified = f.lastModified();
+	auto realModified = f.modified;
 	if (realModified != modified) {
 		DEBUG_LOG(("File location check: Wrong last modified time %1 when should be %2").arg(realModified.toMSecsSinceEpoch()).arg(modified.toMSecsSinceEpoch()));
 		return false;
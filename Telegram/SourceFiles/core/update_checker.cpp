@@ -34,6 +34,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <openssl/rsa.h>
+#include <openssl/sha.h>
 #include <openssl/pem.h>
 #include <openssl/bio.h>
 #include <openssl/err.h>
@@ -41,6 +42,7 @@ extern "C" {
 
 #if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
 #include <LzmaLib.h>
+#include <LzmaDec.h>
 #else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
 #include <lzma.h>
 #endif // else of Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
@@ -50,6 +52,16 @@ namespace {
 
 constexpr auto kUpdaterTimeout = 10 * crl::time(1000);
 constexpr auto kMaxResponseSize = 1024 * 1024;
+constexpr auto kUnpackChunkSize = 1024 * 1024;
+
+// Delta packages format, duplicated in packer.cpp.
+constexpr auto kDeltaPackageFlag = quint32(0x40000000U);
+constexpr auto kDeltaShaLength = 20;
+constexpr auto kDeltaFileFull = quint8(0);
+constexpr auto kDeltaFilePatch = quint8(1);
+constexpr auto kDeltaEnd = quint8(0);
+constexpr auto kDeltaCopy = quint8(1);
+constexpr auto kDeltaInsert = quint8(2);
 
 #ifdef TDESKTOP_DISABLE_AUTOUPDATE
 bool UpdaterIsDisabled = true;
@@ -59,6 +71,10 @@ bool UpdaterIsDisabled = false;
 
 std::weak_ptr<Updater> UpdaterInstance;
 
+// Set if a delta package could not be applied to the installed files,
+// full packages are requested after that.
+std::atomic<bool> DeltaUpdateFailed = false;
+
 using Progress = UpdateChecker::Progress;
 using State = UpdateChecker::State;
 
@@ -248,129 +264,424 @@ QString ExtractFilename(const QString &url) {
 	return QString();
 }
 
-bool UnpackUpdate(const QString &filepath) {
-	QFile input(filepath);
-	if (!input.open(QIODevice::ReadOnly)) {
-		LOG(("Update Error: cant read updates file!"));
-		return false;
+#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
+void *LzmaAlloc(ISzAllocPtr, size_t size) {
+	return malloc(size);
+}
+
+void LzmaFree(ISzAllocPtr, void *address) {
+	free(address);
+}
+
+const ISzAlloc kLzmaAllocator = { LzmaAlloc, LzmaFree };
+#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+
+// Decompresses the update payload from the file chunk by chunk,
+// so that the whole package is never held in memory.
+class UpdatePayloadDevice final : public QIODevice {
+public:
+	UpdatePayloadDevice(
+		not_null<QFile*> input,
+		const QByteArray &props,
+		int64 uncompressedSize);
+	~UpdatePayloadDevice();
+
+	bool start();
+
+	bool isSequential() const override {
+		return true;
+	}
+
+protected:
+	qint64 readData(char *data, qint64 maxSize) override;
+	qint64 writeData(const char *data, qint64 maxSize) override {
+		return -1;
 	}
 
+private:
+	bool fillInput();
+
+	const not_null<QFile*> _input;
+	const QByteArray _props;
+	const int64 _uncompressedSize = 0;
+	QByteArray _buffer;
+	int _bufferOffset = 0;
+	int64 _uncompressed = 0;
+	bool _inputFinished = false;
+	bool _failed = false;
+
 #if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
-	const int32 hSigLen = 128, hShaLen = 20, hPropsLen = LZMA_PROPS_SIZE, hOriginalSizeLen = sizeof(int32), hSize = hSigLen + hShaLen + hPropsLen + hOriginalSizeLen; // header
+	CLzmaDec _state;
+	bool _stateAllocated = false;
 #else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
-	const int32 hSigLen = 128, hShaLen = 20, hPropsLen = 0, hOriginalSizeLen = sizeof(int32), hSize = hSigLen + hShaLen + hOriginalSizeLen; // header
+	lzma_stream _stream = LZMA_STREAM_INIT;
 #endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
 
-	QByteArray compressed = input.readAll();
-	int32 compressedLen = compressed.size() - hSize;
-	if (compressedLen <= 0) {
-		LOG(("Update Error: bad compressed size: %1").arg(compressed.size()));
-		return false;
-	}
-	input.close();
+};
 
-	QString tempDirPath = cWorkingDir() + qsl("tupdates/temp"), readyFilePath = cWorkingDir() + qsl("tupdates/temp/ready");
-	base::Platform::DeleteDirectory(tempDirPath);
+UpdatePayloadDevice::UpdatePayloadDevice(
+	not_null<QFile*> input,
+	const QByteArray &props,
+	int64 uncompressedSize)
+: _input(input)
+, _props(props)
+, _uncompressedSize(uncompressedSize) {
+}
 
-	QDir tempDir(tempDirPath);
-	if (tempDir.exists() || QFile(readyFilePath).exists()) {
-		LOG(("Update Error: cant clear tupdates/temp dir!"));
-		return false;
+UpdatePayloadDevice::~UpdatePayloadDevice() {
+#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
+	if (_stateAllocated) {
+		LzmaDec_Free(&_state, &kLzmaAllocator);
 	}
+#else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+	lzma_end(&_stream);
+#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+}
 
-	uchar sha1Buffer[20];
-	bool goodSha1 = !memcmp(compressed.constData() + hSigLen, hashSha1(compressed.constData() + hSigLen + hShaLen, compressedLen + hPropsLen + hOriginalSizeLen, sha1Buffer), hShaLen);
-	if (!goodSha1) {
-		LOG(("Update Error: bad SHA1 hash of update file!"));
+bool UpdatePayloadDevice::start() {
+#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
+	LzmaDec_Construct(&_state);
+	const auto res = LzmaDec_Allocate(
+		&_state,
+		reinterpret_cast<const Byte*>(_props.constData()),
+		_props.size(),
+		&kLzmaAllocator);
+	if (res != SZ_OK) {
+		LOG(("Update Error: could not init lzma decoder, code: %1"
+			).arg(res));
 		return false;
 	}
-
-	RSA *pbKey = PEM_read_bio_RSAPublicKey(BIO_new_mem_buf(const_cast<char*>(AppBetaVersion ? UpdatesPublicBetaKey : UpdatesPublicKey), -1), 0, 0, 0);
-	if (!pbKey) {
-		LOG(("Update Error: cant read public rsa key!"));
+	_stateAllocated = true;
+	LzmaDec_Init(&_state);
+#else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+	const auto ret = lzma_stream_decoder(
+		&_stream,
+		UINT64_MAX,
+		LZMA_CONCATENATED);
+	if (ret != LZMA_OK) {
+		LOG(("Update Error: could not init lzma decoder, code: %1"
+			).arg(ret));
 		return false;
 	}
-	if (RSA_verify(NID_sha1, (const uchar*)(compressed.constData() + hSigLen), hShaLen, (const uchar*)(compressed.constData()), hSigLen, pbKey) != 1) { // verify signature
-		RSA_free(pbKey);
+#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+	return open(QIODevice::ReadOnly);
+}
+
+bool UpdatePayloadDevice::fillInput() {
+	if (_bufferOffset < _buffer.size() || _inputFinished) {
+		return true;
+	}
+	_buffer = _input->read(kUnpackChunkSize);
+	_bufferOffset = 0;
+	if (_buffer.isEmpty()) {
+		if (!_input->atEnd()) {
+			LOG(("Update Error: could not read the update file."));
+			return false;
+		}
+		_inputFinished = true;
+	}
+	return true;
+}
+
+qint64 UpdatePayloadDevice::readData(char *data, qint64 maxSize) {
+	if (_failed) {
+		return -1;
+	}
+	maxSize = std::min(maxSize, qint64(_uncompressedSize - _uncompressed));
+	auto written = qint64(0);
+	while (written < maxSize) {
+		if (!fillInput()) {
+			_failed = true;
+			return -1;
+		}
+		const auto input = _buffer.constData() + _bufferOffset;
+		const auto inputSize = _buffer.size() - _bufferOffset;
+		const auto output = data + written;
+		const auto outputSize = maxSize - written;
+#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
+		auto srcLen = SizeT(inputSize);
+		auto destLen = SizeT(outputSize);
+		auto status = ELzmaStatus();
+		const auto res = LzmaDec_DecodeToBuf(
+			&_state,
+			reinterpret_cast<Byte*>(output),
+			&destLen,
+			reinterpret_cast<const Byte*>(input),
+			&srcLen,
+			LZMA_FINISH_ANY,
+			&status);
+		if (res != SZ_OK) {
+			LOG(("Update Error: could not uncompress lzma, code: %1"
+				).arg(res));
+			_failed = true;
+			return -1;
+		}
+		_bufferOffset += int(srcLen);
+		written += qint64(destLen);
+		const auto finished = (status == LZMA_STATUS_FINISHED_WITH_MARK)
+			|| (!srcLen && !destLen);
+#else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+		_stream.next_in = reinterpret_cast<const uint8_t*>(input);
+		_stream.avail_in = inputSize;
+		_stream.next_out = reinterpret_cast<uint8_t*>(output);
+		_stream.avail_out = outputSize;
+		const auto res = lzma_code(
+			&_stream,
+			_inputFinished ? LZMA_FINISH : LZMA_RUN);
+		if (res != LZMA_OK && res != LZMA_STREAM_END) {
+			LOG(("Update Error: could not uncompress lzma, code: %1"
+				).arg(res));
+			_failed = true;
+			return -1;
+		}
+		_bufferOffset += int(inputSize - _stream.avail_in);
+		written += qint64(outputSize - _stream.avail_out);
+		const auto finished = (res == LZMA_STREAM_END);
+#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+		if (finished || (_inputFinished && written < maxSize)) {
+			break;
+		}
+	}
+	_uncompressed += written;
+	return written;
+}
 
-		// try other public key, if we update from beta to stable or vice versa
-		pbKey = PEM_read_bio_RSAPublicKey(BIO_new_mem_buf(const_cast<char*>(AppBetaVersion ? UpdatesPublicKey : UpdatesPublicBetaKey), -1), 0, 0, 0);
+bool VerifyUpdateSignature(const QByteArray &sha1, const QByteArray &signature) {
+	const auto verify = [&](const char *key) {
+		const auto pbKey = PEM_read_bio_RSAPublicKey(
+			BIO_new_mem_buf(const_cast<char*>(key), -1),
+			0,
+			0,
+			0);
 		if (!pbKey) {
 			LOG(("Update Error: cant read public rsa key!"));
 			return false;
 		}
-		if (RSA_verify(NID_sha1, (const uchar*)(compressed.constData() + hSigLen), hShaLen, (const uchar*)(compressed.constData()), hSigLen, pbKey) != 1) { // verify signature
-			RSA_free(pbKey);
-			LOG(("Update Error: bad RSA signature of update file!"));
+		const auto result = RSA_verify(
+			NID_sha1,
+			reinterpret_cast<const uchar*>(sha1.constData()),
+			sha1.size(),
+			reinterpret_cast<const uchar*>(signature.constData()),
+			signature.size(),
+			pbKey);
+		RSA_free(pbKey);
+		return (result == 1);
+	};
+
+	// try other public key, if we update from beta to stable or vice versa
+	return verify(AppBetaVersion ? UpdatesPublicBetaKey : UpdatesPublicKey)
+		|| verify(AppBetaVersion ? UpdatesPublicKey : UpdatesPublicBetaKey);
+}
+
+bool CopyUpdateFileData(
+		QDataStream &stream,
+		QFile &output,
+		quint32 size) {
+	auto buffer = QByteArray(kUnpackChunkSize, Qt::Uninitialized);
+	while (size > 0) {
+		const auto chunk = int(std::min(quint32(buffer.size()), size));
+		if (stream.readRawData(buffer.data(), chunk) != chunk) {
+			LOG(("Update Error: cant read file data from downloaded stream"));
+			return false;
+		} else if (output.write(buffer.constData(), chunk) != chunk) {
+			LOG(("Update Error: cant write file '%1'"
+				).arg(output.fileName()));
 			return false;
 		}
+		size -= chunk;
 	}
-	RSA_free(pbKey);
+	return true;
+}
 
-	QByteArray uncompressed;
+// Rebuilds the new file from the installed one and the delta operations,
+// see ComputeDelta() in packer.cpp for the format.
+bool ApplyUpdateDelta(
+		const QString &basePath,
+		const QByteArray &delta,
+		QFile &output,
+		quint32 size) {
+	QFile base(basePath);
+	if (!base.open(QIODevice::ReadOnly)) {
+		LOG(("Update Error: cant open delta base '%1'").arg(basePath));
+		return false;
+	}
 
-	int32 uncompressedLen;
-	memcpy(&uncompressedLen, compressed.constData() + hSigLen + hShaLen + hPropsLen, hOriginalSizeLen);
-	uncompressed.resize(uncompressedLen);
+	QDataStream stream(delta);
+	stream.setVersion(QDataStream::Qt_5_1);
 
-	size_t resultLen = uncompressed.size();
-#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
-	SizeT srcLen = compressedLen;
-	int uncompressRes = LzmaUncompress((uchar*)uncompressed.data(), &resultLen, (const uchar*)(compressed.constData() + hSize), &srcLen, (const uchar*)(compressed.constData() + hSigLen + hShaLen), LZMA_PROPS_SIZE);
-	if (uncompressRes != SZ_OK) {
-		LOG(("Update Error: could not uncompress lzma, code: %1").arg(uncompressRes));
+	QByteArray baseSha1;
+	quint32 baseSize = 0;
+	stream >> baseSha1 >> baseSize;
+	if (stream.status() != QDataStream::Ok
+		|| baseSha1.size() != kDeltaShaLength) {
+		LOG(("Update Error: bad delta header for '%1'").arg(basePath));
+		return false;
+	} else if (base.size() != baseSize) {
+		LOG(("Update Error: delta base '%1' size %2 != %3"
+			).arg(basePath
+			).arg(base.size()
+			).arg(baseSize));
 		return false;
 	}
-#else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
-	lzma_stream stream = LZMA_STREAM_INIT;
 
-	lzma_ret ret = lzma_stream_decoder(&stream, UINT64_MAX, LZMA_CONCATENATED);
-	if (ret != LZMA_OK) {
-		const char *msg;
-		switch (ret) {
-		case LZMA_MEM_ERROR: msg = "Memory allocation failed"; break;
-		case LZMA_OPTIONS_ERROR: msg = "Specified preset is not supported"; break;
-		case LZMA_UNSUPPORTED_CHECK: msg = "Specified integrity check is not supported"; break;
-		default: msg = "Unknown error, possibly a bug"; break;
+	auto sha = SHA_CTX();
+	SHA1_Init(&sha);
+	auto buffer = QByteArray(kUnpackChunkSize, Qt::Uninitialized);
+	while (!base.atEnd()) {
+		const auto read = base.read(buffer.data(), buffer.size());
+		if (read <= 0) {
+			LOG(("Update Error: cant read delta base '%1'").arg(basePath));
+			return false;
 		}
-		LOG(("Error initializing the decoder: %1 (error code %2)").arg(msg).arg(ret));
+		SHA1_Update(&sha, buffer.constData(), read);
+	}
+	auto computed = QByteArray(kDeltaShaLength, Qt::Uninitialized);
+	SHA1_Final(reinterpret_cast<uchar*>(computed.data()), &sha);
+	if (computed != baseSha1) {
+		LOG(("Update Error: delta base '%1' was modified").arg(basePath));
 		return false;
 	}
 
-	stream.avail_in = compressedLen;
-	stream.next_in = (uint8_t*)(compressed.constData() + hSize);
-	stream.avail_out = resultLen;
-	stream.next_out = (uint8_t*)uncompressed.data();
+	auto written = quint32(0);
+	while (true) {
+		quint8 operation = 0;
+		stream >> operation;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("Update Error: bad delta operation in '%1'").arg(basePath));
+			return false;
+		}
+		if (operation == kDeltaEnd) {
+			break;
+		} else if (operation == kDeltaCopy) {
+			quint32 offset = 0, length = 0;
+			stream >> offset >> length;
+			if (stream.status() != QDataStream::Ok
+				|| quint64(offset) + length > baseSize
+				|| !base.seek(offset)) {
+				LOG(("Update Error: bad delta copy in '%1'").arg(basePath));
+				return false;
+			}
+			while (length > 0) {
+				const auto chunk = int(
+					std::min(quint32(buffer.size()), length));
+				if (base.read(buffer.data(), chunk) != chunk
+					|| output.write(buffer.constData(), chunk) != chunk) {
+					LOG(("Update Error: cant copy delta data for '%1'"
+						).arg(output.fileName()));
+					return false;
+				}
+				length -= chunk;
+				written += chunk;
+			}
+		} else if (operation == kDeltaInsert) {
+			QByteArray data;
+			stream >> data;
+			if (stream.status() != QDataStream::Ok
+				|| output.write(data) != data.size()) {
+				LOG(("Update Error: cant insert delta data for '%1'"
+					).arg(output.fileName()));
+				return false;
+			}
+			written += data.size();
+		} else {
+			LOG(("Update Error: unknown delta operation %1 in '%2'"
+				).arg(operation
+				).arg(basePath));
+			return false;
+		}
+	}
+	if (written != size) {
+		LOG(("Update Error: delta result size %1 != %2 for '%3'"
+			).arg(written
+			).arg(size
+			).arg(output.fileName()));
+		return false;
+	}
+	return true;
+}
+
+bool UnpackUpdate(const QString &filepath) {
+	QFile input(filepath);
+	if (!input.open(QIODevice::ReadOnly)) {
+		LOG(("Update Error: cant read updates file!"));
+		return false;
+	}
 
-	lzma_ret res = lzma_code(&stream, LZMA_FINISH);
-	if (stream.avail_in) {
-		LOG(("Error in decompression, %1 bytes left in _in of %2 whole.").arg(stream.avail_in).arg(compressedLen));
+#if defined Q_OS_WIN && !defined DESKTOP_APP_USE_PACKAGED // use Lzma SDK for win
+	const int32 hSigLen = 128, hShaLen = 20, hPropsLen = LZMA_PROPS_SIZE, hOriginalSizeLen = sizeof(int32), hSize = hSigLen + hShaLen + hPropsLen + hOriginalSizeLen; // header
+#else // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+	const int32 hSigLen = 128, hShaLen = 20, hPropsLen = 0, hOriginalSizeLen = sizeof(int32), hSize = hSigLen + hShaLen + hOriginalSizeLen; // header
+#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
+
+	const auto header = input.read(hSize);
+	const auto compressedLen = input.size() - hSize;
+	if (header.size() != hSize || compressedLen <= 0) {
+		LOG(("Update Error: bad compressed size: %1").arg(input.size()));
 		return false;
-	} else if (stream.avail_out) {
-		LOG(("Error in decompression, %1 bytes free left in _out of %2 whole.").arg(stream.avail_out).arg(resultLen));
+	}
+
+	QString tempDirPath = cWorkingDir() + qsl("tupdates/temp"), readyFilePath = cWorkingDir() + qsl("tupdates/temp/ready");
+	base::Platform::DeleteDirectory(tempDirPath);
+
+	QDir tempDir(tempDirPath);
+	if (tempDir.exists() || QFile(readyFilePath).exists()) {
+		LOG(("Update Error: cant clear tupdates/temp dir!"));
 		return false;
 	}
-	lzma_end(&stream);
-	if (res != LZMA_OK && res != LZMA_STREAM_END) {
-		const char *msg;
-		switch (res) {
-		case LZMA_MEM_ERROR: msg = "Memory allocation failed"; break;
-		case LZMA_FORMAT_ERROR: msg = "The input data is not in the .xz format"; break;
-		case LZMA_OPTIONS_ERROR: msg = "Unsupported compression options"; break;
-		case LZMA_DATA_ERROR: msg = "Compressed file is corrupt"; break;
-		case LZMA_BUF_ERROR: msg = "Compressed data is truncated or otherwise corrupt"; break;
-		default: msg = "Unknown error, possibly a bug"; break;
+
+	{
+		// Hash the file by chunks instead of reading it all to memory.
+		auto sha = SHA_CTX();
+		SHA1_Init(&sha);
+		SHA1_Update(
+			&sha,
+			header.constData() + hSigLen + hShaLen,
+			hPropsLen + hOriginalSizeLen);
+		auto buffer = QByteArray(kUnpackChunkSize, Qt::Uninitialized);
+		while (!input.atEnd()) {
+			const auto read = input.read(buffer.data(), buffer.size());
+			if (read <= 0) {
+				LOG(("Update Error: cant read updates file!"));
+				return false;
+			}
+			SHA1_Update(&sha, buffer.constData(), read);
 		}
-		LOG(("Error in decompression: %1 (error code %2)").arg(msg).arg(res));
+		auto sha1 = QByteArray(hShaLen, Qt::Uninitialized);
+		SHA1_Final(reinterpret_cast<uchar*>(sha1.data()), &sha);
+		if (sha1 != header.mid(hSigLen, hShaLen)) {
+			LOG(("Update Error: bad SHA1 hash of update file!"));
+			return false;
+		} else if (!VerifyUpdateSignature(sha1, header.mid(0, hSigLen))) {
+			LOG(("Update Error: bad RSA signature of update file!"));
+			return false;
+		}
+	}
+
+	int32 uncompressedLen;
+	memcpy(&uncompressedLen, header.constData() + hSigLen + hShaLen + hPropsLen, hOriginalSizeLen);
+	if (uncompressedLen <= 0) {
+		LOG(("Update Error: bad uncompressed size: %1").arg(uncompressedLen));
+		return false;
+	}
+
+	if (!input.seek(hSize)) {
+		LOG(("Update Error: cant seek in updates file!"));
+		return false;
+	}
+	UpdatePayloadDevice payload(
+		&input,
+		header.mid(hSigLen + hShaLen, hPropsLen),
+		uncompressedLen);
+	if (!payload.start()) {
 		return false;
 	}
-#endif // Q_OS_WIN && !DESKTOP_APP_USE_PACKAGED
 
 	tempDir.mkdir(tempDir.absolutePath());
 
 	quint32 version;
+	auto delta = false;
 	{
-		QDataStream stream(uncompressed);
+		QDataStream stream(&payload);
 		stream.setVersion(QDataStream::Qt_5_1);
 
 		stream >> version;
@@ -401,6 +712,20 @@ bool UnpackUpdate(const QString &filepath) {
 			LOG(("Update Error: cant read files count from downloaded stream, status: %1").arg(stream.status()));
 			return false;
 		}
+		delta = (filesCount & kDeltaPackageFlag) != 0;
+		filesCount &= ~kDeltaPackageFlag;
+		if (delta) {
+			quint32 baseVersion = 0;
+			stream >> baseVersion;
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("Update Error: cant read delta base version, status: %1").arg(stream.status()));
+				return false;
+			} else if (cAlphaVersion() || int32(baseVersion) != AppVersion) {
+				LOG(("Update Error: delta update is made for version %1, mine is %2").arg(baseVersion).arg(AppVersion));
+				DeltaUpdateFailed = true;
+				return false;
+			}
+		}
 		if (!filesCount) {
 			LOG(("Update Error: update is empty!"));
 			return false;
@@ -408,21 +733,17 @@ bool UnpackUpdate(const QString &filepath) {
 		for (uint32 i = 0; i < filesCount; ++i) {
 			QString relativeName;
 			quint32 fileSize;
-			QByteArray fileInnerData;
+			quint8 kind = kDeltaFileFull;
 			bool executable = false;
 
-			stream >> relativeName >> fileSize >> fileInnerData;
-#ifdef Q_OS_UNIX
-			stream >> executable;
-#endif // Q_OS_UNIX
+			stream >> relativeName >> fileSize;
+			if (delta) {
+				stream >> kind;
+			}
 			if (stream.status() != QDataStream::Ok) {
 				LOG(("Update Error: cant read file from downloaded stream, status: %1").arg(stream.status()));
 				return false;
 			}
-			if (fileSize != quint32(fileInnerData.size())) {
-				LOG(("Update Error: bad file size %1 not matching data size %2").arg(fileSize).arg(fileInnerData.size()));
-				return false;
-			}
 
 			QFile f(tempDirPath + '/' + relativeName);
 			if (!QDir().mkpath(QFileInfo(f).absolutePath())) {
@@ -433,10 +754,41 @@ bool UnpackUpdate(const QString &filepath) {
 				LOG(("Update Error: cant open file '%1' for writing").arg(tempDirPath + '/' + relativeName));
 				return false;
 			}
-			auto writtenBytes = f.write(fileInnerData);
-			if (writtenBytes != fileSize) {
-				f.close();
-				LOG(("Update Error: cant write file '%1', desiredSize: %2, write result: %3").arg(tempDirPath + '/' + relativeName).arg(fileSize).arg(writtenBytes));
+			if (kind == kDeltaFileFull) {
+				// QByteArray is serialized as its size and the raw bytes.
+				quint32 dataSize;
+				stream >> dataSize;
+				if (dataSize == 0xFFFFFFFFU) { // null QByteArray
+					dataSize = 0;
+				}
+				if (stream.status() != QDataStream::Ok) {
+					LOG(("Update Error: cant read file size from downloaded stream, status: %1").arg(stream.status()));
+					return false;
+				} else if (fileSize != dataSize) {
+					LOG(("Update Error: bad file size %1 not matching data size %2").arg(fileSize).arg(dataSize));
+					return false;
+				} else if (!CopyUpdateFileData(stream, f, dataSize)) {
+					return false;
+				}
+			} else if (kind == kDeltaFilePatch) {
+				QByteArray operations;
+				stream >> operations;
+				if (stream.status() != QDataStream::Ok) {
+					LOG(("Update Error: cant read file delta from downloaded stream, status: %1").arg(stream.status()));
+					return false;
+				} else if (!ApplyUpdateDelta(cExeDir() + relativeName, operations, f, fileSize)) {
+					DeltaUpdateFailed = true;
+					return false;
+				}
+			} else {
+				LOG(("Update Error: unknown file kind %1 for '%2'").arg(kind).arg(relativeName));
+				return false;
+			}
+#ifdef Q_OS_UNIX
+			stream >> executable;
+#endif // Q_OS_UNIX
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("Update Error: cant read file from downloaded stream, status: %1").arg(stream.status()));
 				return false;
 			}
 			f.close();
@@ -471,6 +823,10 @@ bool UnpackUpdate(const QString &filepath) {
 		fVersion.close();
 	}
 
+	if (delta) {
+		LOG(("Update Info: delta update unpacked."));
+	}
+
 	QFile readyFile(readyFilePath);
 	if (readyFile.open(QIODevice::WriteOnly)) {
 		if (readyFile.write("1", 1)) {
@@ -719,6 +1075,21 @@ std::optional<QString> HttpChecker::parseResponse(
 			return false;
 		}
 		bestLink = (*link).toString();
+
+		// Optional "delta": { "<installed version>": "<link>" } map.
+		const auto delta = map.constFind("delta");
+		if (isAlpha
+			|| cAlphaVersion()
+			|| DeltaUpdateFailed
+			|| delta == map.constEnd()
+			|| !(*delta).isObject()) {
+			return true;
+		}
+		const auto deltaLink = (*delta).toObject().value(
+			QString::number(AppVersion));
+		if (deltaLink.isString()) {
+			bestLink = deltaLink.toString();
+		}
 		return true;
 	};
 	const auto result = ParseCommonMap(response, testing(), accumulate);
@@ -222,6 +222,10 @@ void LoadCloudFile(
 		}
 		if (file.loader->loadSize() < loadSize) {
 			file.loader->increaseLoadSize(loadSize, autoLoading);
+		} else if (!autoLoading) {
+			file.loader->stopAutoLoading();
+		} else {
+			file.loader->refreshAutoLoading();
 		}
 		return;
 	} else if ((file.flags & CloudFile::Flag::Failed)
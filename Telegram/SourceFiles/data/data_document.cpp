@@ -775,6 +775,10 @@ Storage::Cache::Key DocumentData::goodThumbnailCacheKey() const {
 	return Data::DocumentThumbCacheKey(_dc, id);
 }
 
+Storage::Cache::Key DocumentData::waveformCacheKey() const {
+	return Data::DocumentWaveformCacheKey(_dc, id);
+}
+
 bool DocumentData::goodThumbnailChecked() const {
 	return (_goodThumbnailState & GoodThumbnailFlag::Mask)
 		== GoodThumbnailFlag::Checked;
@@ -1009,6 +1013,11 @@ void DocumentData::save(
 		if (fromCloud == LoadFromCloudOrLocal) {
 			_loader->permitLoadFromCloud();
 		}
+		if (!autoLoading) {
+			_loader->stopAutoLoading();
+		} else {
+			_loader->refreshAutoLoading();
+		}
 	} else {
 		status = FileReady;
 		auto reader = owner().streaming().sharedReader(this, origin, true);
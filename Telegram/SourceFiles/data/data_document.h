@@ -77,6 +77,10 @@ struct VoiceData : public DocumentAdditionalData {
 	int duration = 0;
 	VoiceWaveform waveform;
 	char wavemax = 0;
+
+	// Counted so far, while the waveform is being counted locally.
+	VoiceWaveform partialWaveform;
+	char partialWavemax = 0;
 };
 
 namespace Serialize {
@@ -183,6 +187,7 @@ public:
 	}
 
 	[[nodiscard]] Storage::Cache::Key goodThumbnailCacheKey() const;
+	[[nodiscard]] Storage::Cache::Key waveformCacheKey() const;
 	[[nodiscard]] bool goodThumbnailChecked() const;
 	[[nodiscard]] bool goodThumbnailGenerating() const;
 	[[nodiscard]] bool goodThumbnailNoData() const;
@@ -25,6 +25,9 @@ namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
 
+// Read requests are not urgent, let them share a container with others.
+constexpr auto kReadRequestSendDelay = crl::time(20);
+
 } // namespace
 
 Histories::Histories(not_null<Session*> owner)
@@ -512,7 +515,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 				finished();
 			}).fail([=](const MTP::Error &error) {
 				finished();
-			}).send();
+			}).afterDelay(kReadRequestSendDelay).send();
 		} else {
 			return session().api().request(MTPmessages_ReadHistory(
 				history->peer->input,
@@ -522,7 +525,7 @@ void Histories::sendReadRequest(not_null<History*> history, State &state) {
 				finished();
 			}).fail([=](const MTP::Error &error) {
 				finished();
-			}).send();
+			}).afterDelay(kReadRequestSendDelay).send();
 		}
 	});
 }
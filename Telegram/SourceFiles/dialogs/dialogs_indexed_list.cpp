@@ -55,10 +55,18 @@ Row *IndexedList::addByName(Key key) {
 void IndexedList::adjustByDate(const RowsByLetter &links) {
 	_list.adjustByDate(links.main);
 	for (const auto &[ch, row] : links.letters) {
-		if (auto it = _index.find(ch); it != _index.cend()) {
-			it->second.adjustByDate(row);
-		}
+		_unsortedLetters.emplace(ch);
+	}
+}
+
+const List *IndexedList::filtered(QChar ch) const {
+	const auto i = _index.find(ch);
+	if (i == _index.end()) {
+		return nullptr;
+	} else if (_unsortedLetters.remove(ch)) {
+		i->second.sortByDate();
 	}
+	return &i->second;
 }
 
 void IndexedList::moveToTop(Key key) {
@@ -198,6 +206,7 @@ void IndexedList::del(Key key, Row *replacedBy) {
 
 void IndexedList::clear() {
 	_index.clear();
+	_unsortedLetters.clear();
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
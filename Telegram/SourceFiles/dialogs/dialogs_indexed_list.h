@@ -43,10 +43,7 @@ public:
 	const List &all() const {
 		return _list;
 	}
-	const List *filtered(QChar ch) const {
-		const auto i = _index.find(ch);
-		return (i != _index.end()) ? &i->second : nullptr;
-	}
+	const List *filtered(QChar ch) const;
 	std::vector<not_null<Row*>> filtered(const QStringList &words) const;
 
 	// Part of List interface is duplicated here for all() list.
@@ -83,7 +80,12 @@ private:
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
-	base::flat_map<QChar, List> _index;
+
+	// In SortMode::Date the letter lists are views of the _list order.
+	// A new message reorders only _list and marks the letters of the
+	// chat, their lists are sorted when they are read next time.
+	mutable base::flat_map<QChar, List> _index;
+	mutable base::flat_set<QChar> _unsortedLetters;
 
 };
 
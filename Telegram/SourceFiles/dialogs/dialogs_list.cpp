@@ -14,14 +14,203 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Dialogs {
 
+List::const_iterator::const_iterator(
+	not_null<const List*> list,
+	int index,
+	Row *row)
+: _list(list)
+, _index(index)
+, _row(row) {
+}
+
+List::const_iterator &List::const_iterator::operator++() {
+	Expects(_row != nullptr);
+
+	_row = List::Next(_row);
+	++_index;
+	return *this;
+}
+
+List::const_iterator &List::const_iterator::operator--() {
+	Expects(_index > 0);
+
+	_row = _row ? List::Prev(_row) : _list->select(_index - 1);
+	--_index;
+	return *this;
+}
+
+List::const_iterator &List::const_iterator::operator+=(
+		difference_type offset) {
+	if (offset == 1) {
+		return ++*this;
+	} else if (offset == -1) {
+		return --*this;
+	} else if (offset) {
+		_index += offset;
+		_row = _list->select(_index);
+	}
+	return *this;
+}
+
 List::List(SortMode sortMode, FilterId filterId)
 : _sortMode(sortMode)
 , _filterId(filterId) {
 }
 
+List::List(List &&other)
+: _sortMode(other._sortMode)
+, _filterId(other._filterId)
+, _root(base::take(other._root))
+, _rowByKey(base::take(other._rowByKey)) {
+}
+
+List &List::operator=(List &&other) {
+	if (this != &other) {
+		_sortMode = other._sortMode;
+		_filterId = other._filterId;
+		_root = base::take(other._root);
+		_rowByKey = base::take(other._rowByKey);
+	}
+	return *this;
+}
+
+int List::Count(Row *node) {
+	return node ? node->_count : 0;
+}
+
+void List::Update(not_null<Row*> node) {
+	node->_count = Count(node->_left) + Count(node->_right) + 1;
+	if (node->_left) {
+		node->_left->_parent = node;
+	}
+	if (node->_right) {
+		node->_right->_parent = node;
+	}
+}
+
+void List::Split(Row *node, int count, Row *&left, Row *&right) {
+	if (!node) {
+		left = right = nullptr;
+		return;
+	}
+	const auto before = Count(node->_left);
+	if (before < count) {
+		Split(node->_right, count - before - 1, node->_right, right);
+		left = node;
+	} else {
+		Split(node->_left, count, left, node->_left);
+		right = node;
+	}
+	Update(node);
+}
+
+Row *List::Merge(Row *left, Row *right) {
+	if (!left || !right) {
+		return left ? left : right;
+	} else if (left->_priority > right->_priority) {
+		left->_right = Merge(left->_right, right);
+		Update(left);
+		return left;
+	}
+	right->_left = Merge(left, right->_left);
+	Update(right);
+	return right;
+}
+
+Row *List::Next(not_null<Row*> row) {
+	if (auto result = row->_right) {
+		while (result->_left) {
+			result = result->_left;
+		}
+		return result;
+	}
+	while (row->_parent && row->_parent->_right == row) {
+		row = row->_parent;
+	}
+	return row->_parent;
+}
+
+Row *List::Prev(not_null<Row*> row) {
+	if (auto result = row->_left) {
+		while (result->_right) {
+			result = result->_right;
+		}
+		return result;
+	}
+	while (row->_parent && row->_parent->_left == row) {
+		row = row->_parent;
+	}
+	return row->_parent;
+}
+
+List::const_iterator List::at(int index) const {
+	return const_iterator(this, index, select(index));
+}
+
+Row *List::select(int index) const {
+	auto node = _root;
+	while (node) {
+		const auto before = Count(node->_left);
+		if (index < before) {
+			node = node->_left;
+		} else if (index == before) {
+			return node;
+		} else {
+			index -= before + 1;
+			node = node->_right;
+		}
+	}
+	return nullptr;
+}
+
+template <typename GoesBefore>
+int List::countBefore(GoesBefore &&goesBefore) const {
+	auto result = 0;
+	auto node = _root;
+	while (node) {
+		if (goesBefore(node)) {
+			result += Count(node->_left) + 1;
+			node = node->_right;
+		} else {
+			node = node->_left;
+		}
+	}
+	return result;
+}
+
+void List::setRoot(Row *root) {
+	_root = root;
+	if (_root) {
+		_root->_parent = nullptr;
+	}
+}
+
+void List::insert(not_null<Row*> row, int index) {
+	Expects(row->_parent == nullptr);
+	Expects(row->_left == nullptr && row->_right == nullptr);
+
+	auto left = (Row*)nullptr;
+	auto right = (Row*)nullptr;
+	Split(_root, index, left, right);
+	setRoot(Merge(Merge(left, row), right));
+}
+
+void List::erase(not_null<Row*> row) {
+	auto left = (Row*)nullptr;
+	auto middle = (Row*)nullptr;
+	auto right = (Row*)nullptr;
+	Split(_root, row->pos(), left, middle);
+	Split(middle, 1, middle, right);
+	Assert(middle == row);
+
+	setRoot(Merge(left, right));
+	row->_parent = row->_left = row->_right = nullptr;
+	row->_count = 1;
+}
+
 List::const_iterator List::cfind(Row *value) const {
 	return value
-		? (cbegin() + value->pos())
+		? const_iterator(this, value->pos(), value)
 		: cend();
 }
 
@@ -31,9 +220,9 @@ not_null<Row*> List::addToEnd(Key key) {
 	}
 	const auto result = _rowByKey.emplace(
 		key,
-		std::make_unique<Row>(key, _rows.size())
+		std::make_unique<Row>(key)
 	).first->second.get();
-	_rows.emplace_back(result);
+	insert(result, size() - 1);
 	if (_sortMode == SortMode::Date) {
 		adjustByDate(result);
 	}
@@ -60,73 +249,67 @@ not_null<Row*> List::addByName(Key key) {
 }
 
 void List::adjustByName(not_null<Row*> row) {
-	Expects(row->pos() >= 0 && row->pos() < _rows.size());
-
 	const auto &key = row->entry()->chatListNameSortKey();
-	const auto index = row->pos();
-	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return row->entry()->chatListNameSortKey().compare(key) >= 0;
-	});
-	if (before != i + 1) {
-		rotate(i, i + 1, before);
-	} else if (i != _rows.begin()) {
-		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return row->entry()->chatListNameSortKey().compare(key) <= 0;
-		}).base();
-		if (after != i) {
-			rotate(after, i, i + 1);
-		}
+	const auto compare = [&](not_null<Row*> other) {
+		return other->entry()->chatListNameSortKey().compare(key);
+	};
+	const auto prev = Prev(row);
+	const auto next = Next(row);
+	if ((!prev || compare(prev) <= 0) && (!next || compare(next) >= 0)) {
+		return;
 	}
+	erase(row);
+	insert(row, countBefore([&](not_null<Row*> other) {
+		return (compare(other) < 0);
+	}));
 }
 
 void List::adjustByDate(not_null<Row*> row) {
 	Expects(_sortMode == SortMode::Date);
 
 	const auto key = row->sortKey(_filterId);
-	const auto index = row->pos();
-	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return (row->sortKey(_filterId) <= key);
+	const auto prev = Prev(row);
+	const auto next = Next(row);
+	if ((!prev || prev->sortKey(_filterId) >= key)
+		&& (!next || next->sortKey(_filterId) <= key)) {
+		return;
+	}
+	erase(row);
+	insert(row, countBefore([&](not_null<Row*> other) {
+		return (other->sortKey(_filterId) > key);
+	}));
+}
+
+void List::sortByDate() {
+	Expects(_sortMode == SortMode::Date);
+
+	auto rows = std::vector<not_null<Row*>>();
+	rows.reserve(size());
+	for (const auto row : *this) {
+		rows.push_back(row);
+	}
+	const auto filterId = _filterId;
+	ranges::stable_sort(rows, std::greater<>(), [&](not_null<Row*> row) {
+		return row->sortKey(filterId);
 	});
-	if (before != i + 1) {
-		rotate(i, i + 1, before);
-	} else {
-		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return (row->sortKey(_filterId) >= key);
-		}).base();
-		if (after != i) {
-			rotate(after, i, i + 1);
-		}
+	_root = nullptr;
+	for (const auto row : rows) {
+		row->_parent = row->_left = row->_right = nullptr;
+		row->_count = 1;
+		setRoot(Merge(_root, row));
 	}
 }
 
 bool List::moveToTop(Key key) {
-	const auto i = _rowByKey.find(key);
-	if (i == _rowByKey.cend()) {
+	const auto row = getRow(key);
+	if (!row) {
 		return false;
 	}
-	const auto index = i->second->pos();
-	const auto begin = _rows.begin();
-	rotate(begin, begin + index, begin + index + 1);
+	erase(row);
+	insert(row, 0);
 	return true;
 }
 
-void List::rotate(
-		std::vector<not_null<Row*>>::iterator first,
-		std::vector<not_null<Row*>>::iterator middle,
-		std::vector<not_null<Row*>>::iterator last) {
-	std::rotate(first, middle, last);
-
-	auto count = (last - first);
-	auto index = (first - _rows.begin());
-	while (count--) {
-		(*first++)->_pos = index++;
-	}
-}
-
 bool List::del(Key key, Row *replacedBy) {
 	auto i = _rowByKey.find(key);
 	if (i == _rowByKey.cend()) {
@@ -136,11 +319,7 @@ bool List::del(Key key, Row *replacedBy) {
 	const auto row = i->second.get();
 	row->entry()->owner().dialogsRowReplaced({ row, replacedBy });
 
-	const auto index = row->pos();
-	_rows.erase(_rows.begin() + index);
-	for (auto i = index, count = int(_rows.size()); i != count; ++i) {
-		_rows[i]->_pos = i;
-	}
+	erase(row);
 	_rowByKey.erase(i);
 	return true;
 }
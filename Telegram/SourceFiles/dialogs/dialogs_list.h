@@ -14,20 +14,119 @@ namespace Dialogs {
 
 enum class SortMode;
 
+// Rows are kept in an order-statistic tree (a treap, nodes are the rows
+// themselves), so that moving a row or finding it by index is O(log n).
 class List final {
 public:
+	class const_iterator final {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = not_null<Row*>;
+		using difference_type = int;
+		using pointer = void;
+		using reference = not_null<Row*>;
+
+		const_iterator() = default;
+
+		reference operator*() const {
+			return _row;
+		}
+		reference operator[](difference_type offset) const {
+			return *(*this + offset);
+		}
+
+		const_iterator &operator++();
+		const_iterator &operator--();
+		const_iterator operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+		const_iterator operator--(int) {
+			auto result = *this;
+			--*this;
+			return result;
+		}
+		const_iterator &operator+=(difference_type offset);
+		const_iterator &operator-=(difference_type offset) {
+			return *this += -offset;
+		}
+		friend const_iterator operator+(
+				const_iterator i,
+				difference_type offset) {
+			return i += offset;
+		}
+		friend const_iterator operator+(
+				difference_type offset,
+				const_iterator i) {
+			return i += offset;
+		}
+		friend const_iterator operator-(
+				const_iterator i,
+				difference_type offset) {
+			return i -= offset;
+		}
+		friend difference_type operator-(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return a._index - b._index;
+		}
+
+		friend inline bool operator==(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return (a._index == b._index);
+		}
+		friend inline bool operator!=(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return !(a == b);
+		}
+		friend inline bool operator<(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return (a._index < b._index);
+		}
+		friend inline bool operator>(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return (b < a);
+		}
+		friend inline bool operator<=(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return !(b < a);
+		}
+		friend inline bool operator>=(
+				const const_iterator &a,
+				const const_iterator &b) {
+			return !(a < b);
+		}
+
+	private:
+		friend class List;
+
+		const_iterator(not_null<const List*> list, int index, Row *row);
+
+		const List *_list = nullptr;
+		int _index = 0;
+		Row *_row = nullptr;
+
+	};
+	using iterator = const_iterator;
+
 	List(SortMode sortMode, FilterId filterId = 0);
 	List(const List &other) = delete;
 	List &operator=(const List &other) = delete;
-	List(List &&other) = default;
-	List &operator=(List &&other) = default;
+	List(List &&other);
+	List &operator=(List &&other);
 	~List() = default;
 
 	int size() const {
-		return _rows.size();
+		return _rowByKey.size();
 	}
 	bool empty() const {
-		return _rows.empty();
+		return _rowByKey.empty();
 	}
 	bool contains(Key key) const {
 		return _rowByKey.find(key) != _rowByKey.end();
@@ -38,7 +137,7 @@ public:
 	}
 	Row *rowAtY(int y, int h) const {
 		const auto i = cfind(y, h);
-		if (i == cend() || (*i)->pos() != ((y > 0) ? (y / h) : 0)) {
+		if (i == cend() || i._index != ((y > 0) ? (y / h) : 0)) {
 			return nullptr;
 		}
 		return *i;
@@ -49,13 +148,11 @@ public:
 	not_null<Row*> addByName(Key key);
 	bool moveToTop(Key key);
 	void adjustByDate(not_null<Row*> row);
+	void sortByDate();
 	bool del(Key key, Row *replacedBy = nullptr);
 
-	using const_iterator = std::vector<not_null<Row*>>::const_iterator;
-	using iterator = const_iterator;
-
-	const_iterator cbegin() const { return _rows.cbegin(); }
-	const_iterator cend() const { return _rows.cend(); }
+	const_iterator cbegin() const { return at(0); }
+	const_iterator cend() const { return at(size()); }
 	const_iterator begin() const { return cbegin(); }
 	const_iterator end() const { return cend(); }
 	iterator begin() { return cbegin(); }
@@ -64,22 +161,32 @@ public:
 	const_iterator find(Row *value) const { return cfind(value); }
 	iterator find(Row *value) { return cfind(value); }
 	const_iterator cfind(int y, int h) const {
-		const auto index = std::max(y, 0) / h;
-		return _rows.begin() + std::min(index, size());
+		return at(std::min(std::max(y, 0) / h, size()));
 	}
 	const_iterator find(int y, int h) const { return cfind(y, h); }
 	iterator find(int y, int h) { return cfind(y, h); }
 
 private:
+	[[nodiscard]] static int Count(Row *node);
+	static void Update(not_null<Row*> node);
+	static void Split(Row *node, int count, Row *&left, Row *&right);
+	[[nodiscard]] static Row *Merge(Row *left, Row *right);
+	[[nodiscard]] static Row *Next(not_null<Row*> row);
+	[[nodiscard]] static Row *Prev(not_null<Row*> row);
+
+	[[nodiscard]] const_iterator at(int index) const;
+	[[nodiscard]] Row *select(int index) const;
+	template <typename GoesBefore>
+	[[nodiscard]] int countBefore(GoesBefore &&goesBefore) const;
+	void setRoot(Row *root);
+	void insert(not_null<Row*> row, int index);
+	void erase(not_null<Row*> row);
+
 	void adjustByName(not_null<Row*> row);
-	void rotate(
-		std::vector<not_null<Row*>>::iterator first,
-		std::vector<not_null<Row*>>::iterator middle,
-		std::vector<not_null<Row*>>::iterator last);
 
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
-	std::vector<not_null<Row*>> _rows;
+	Row *_root = nullptr;
 	std::map<Key, std::unique_ptr<Row>> _rowByKey;
 
 };
@@ -20,6 +20,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Dialogs {
 namespace {
 
+// Treap priorities must only be spread evenly, not unpredictable.
+// Rows are created on the main thread, so a plain xorshift is enough.
+[[nodiscard]] uint32 GenerateTreapPriority() {
+	static auto state = uint32(0x9E3779B9U);
+	state ^= (state << 13);
+	state ^= (state >> 17);
+	state ^= (state << 5);
+	return state;
+}
+
 QString ComposeFolderListEntryText(not_null<Data::Folder*> folder) {
 	const auto &list = folder->lastHistories();
 	if (list.empty()) {
@@ -257,12 +267,35 @@ void BasicRow::paintUserpic(
 	p.setOpacity(1.);
 }
 
-Row::Row(Key key, int pos) : _id(key), _pos(pos) {
+Row::Row(Key key)
+: _id(key)
+, _priority(GenerateTreapPriority()) {
 	if (const auto history = key.history()) {
 		updateCornerBadgeShown(history->peer);
 	}
 }
 
+Row::Row(Key key, int fixedPos)
+: Row(key) {
+	Expects(fixedPos >= 0);
+
+	_fixedPos = fixedPos;
+}
+
+int Row::pos() const {
+	if (_fixedPos >= 0) {
+		return _fixedPos;
+	}
+	auto result = _left ? _left->_count : 0;
+	for (auto node = this; node->_parent; node = node->_parent) {
+		const auto parent = node->_parent;
+		if (parent->_right == node) {
+			result += (parent->_left ? parent->_left->_count : 0) + 1;
+		}
+	}
+	return result;
+}
+
 uint64 Row::sortKey(FilterId filterId) const {
 	return _id.entry()->sortKeyInChatList(filterId);
 }
@@ -89,7 +89,10 @@ class Row : public BasicRow {
 public:
 	explicit Row(std::nullptr_t) {
 	}
-	Row(Key key, int pos);
+	explicit Row(Key key);
+
+	// For rows outside of any List, like global peer search results.
+	Row(Key key, int fixedPos);
 
 	Key key() const {
 		return _id;
@@ -103,9 +106,7 @@ public:
 	not_null<Entry*> entry() const {
 		return _id.entry();
 	}
-	int pos() const {
-		return _pos;
-	}
+	[[nodiscard]] int pos() const;
 	uint64 sortKey(FilterId filterId) const;
 
 	void validateListEntryCache() const;
@@ -120,7 +121,15 @@ private:
 	friend class List;
 
 	Key _id;
-	int _pos = 0;
+
+	// Node of the order-statistic tree in which List keeps its rows.
+	Row *_parent = nullptr;
+	Row *_left = nullptr;
+	Row *_right = nullptr;
+	int _count = 1;
+	uint32 _priority = 0;
+	int _fixedPos = -1;
+
 	mutable uint32 _listEntryCacheVersion = 0;
 	mutable Ui::Text::String _listEntryCache;
 
@@ -604,7 +604,12 @@ struct DialogInfo {
 	bool isLeftChannel = false;
 	QString relativePath;
 
+	// Messages up to this id were written by the previous export.
+	int32 exportedTillId = 0;
+
 	// Filled when requesting dialog messages.
+	// In incremental mode only the new messages are requested and
+	// their count is unknown, then it is -1 for non-empty splits.
 	std::vector<int> messagesCountPerSplit;
 };
 
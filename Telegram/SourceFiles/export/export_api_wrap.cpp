@@ -974,6 +974,7 @@ void ApiWrap::requestMessages(
 	_chatProcess->fileProgress = std::move(progress);
 	_chatProcess->handleSlice = std::move(slice);
 	_chatProcess->done = std::move(done);
+	_chatProcess->largestIdPlusOne = info.exportedTillId + 1;
 
 	requestMessagesCount(0);
 }
@@ -982,6 +983,12 @@ void ApiWrap::requestMessagesCount(int localSplitIndex) {
 	Expects(_chatProcess != nullptr);
 	Expects(localSplitIndex < _chatProcess->info.splits.size());
 
+	if (_chatProcess->info.exportedTillId > 0
+		&& _chatProcess->info.splits[localSplitIndex] < 0) {
+		// History before the migration was fully exported already.
+		messagesCountLoaded(localSplitIndex, 0);
+		return;
+	}
 	requestChatMessages(
 		_chatProcess->info.splits[localSplitIndex],
 		0, // offset_id
@@ -1012,7 +1019,9 @@ void ApiWrap::requestMessagesCount(int localSplitIndex) {
 			messagesCountLoaded(localSplitIndex, 0);
 			return;
 		}
-		checkFirstMessageDate(localSplitIndex, count);
+		// The count is of the whole history even with min_id.
+		const auto incremental = (_chatProcess->info.exportedTillId > 0);
+		checkFirstMessageDate(localSplitIndex, incremental ? -1 : count);
 	});
 }
 
@@ -1427,6 +1436,9 @@ void ApiWrap::requestChatMessages(
 	const auto realSplitIndex = (splitIndex >= 0)
 		? splitIndex
 		: (splitsCount + splitIndex);
+	const auto minId = (splitIndex >= 0)
+		? _chatProcess->info.exportedTillId
+		: 0;
 	if (_chatProcess->info.onlyMyMessages) {
 		splitRequest(realSplitIndex, MTPmessages_Search(
 			MTP_flags(MTPmessages_Search::Flag::f_from_id),
@@ -1441,7 +1453,7 @@ void ApiWrap::requestChatMessages(
 			MTP_int(addOffset),
 			MTP_int(limit),
 			MTP_int(0), // max_id
-			MTP_int(0), // min_id
+			MTP_int(minId),
 			MTP_int(0) // hash
 		)).done(doneHandler).send();
 	} else {
@@ -1452,7 +1464,7 @@ void ApiWrap::requestChatMessages(
 			MTP_int(addOffset),
 			MTP_int(limit),
 			MTP_int(0), // max_id
-			MTP_int(0), // min_id
+			MTP_int(minId),
 			MTP_int(0)  // hash
 		)).fail([=](const MTP::Error &error) {
 			Expects(_chatProcess != nullptr);
@@ -1574,7 +1586,7 @@ void ApiWrap::finishMessagesSlice() {
 		&& (++_chatProcess->localSplitIndex
 			< _chatProcess->info.splits.size())) {
 		_chatProcess->lastSlice = false;
-		_chatProcess->largestIdPlusOne = 1;
+		_chatProcess->largestIdPlusOne = _chatProcess->info.exportedTillId + 1;
 	}
 	if (!_chatProcess->lastSlice) {
 		requestMessagesSlice();
@@ -12,9 +12,12 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
 #include "export/output/export_output_result.h"
+#include "export/output/export_output_state.h"
 #include "export/output/export_output_stats.h"
 #include "mtproto/mtp_instance.h"
 
+#include <QtCore/QDir>
+
 namespace Export {
 namespace {
 
@@ -78,6 +81,8 @@ private:
 	void exportOtherData();
 	void exportDialogs();
 	void exportNextDialog();
+	void applyExportedState();
+	void rememberExported(const Data::MessagesSlice &slice);
 
 	template <typename Callback = const decltype(kNullStateCallback) &>
 	ProcessingState prepareState(
@@ -106,6 +111,9 @@ private:
 	Data::DialogsInfo _dialogsInfo;
 	int _dialogIndex = -1;
 
+	QString _stateFolder;
+	Output::ExportedState _exportedState;
+
 	int _messagesWritten = 0;
 	int _messagesCount = 0;
 
@@ -239,6 +247,13 @@ void ControllerObject::startExport(
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
 
+	if (_settings.incremental) {
+		// The state is kept in the chosen folder, the export itself
+		// goes to a new subfolder there each time.
+		const auto folder = QDir(_settings.path).absolutePath();
+		_stateFolder = folder.endsWith('/') ? folder : (folder + '/');
+		_exportedState = Output::ReadExportedState(_stateFolder);
+	}
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
@@ -315,6 +330,13 @@ void ControllerObject::exportNext() {
 	if (++_stepIndex >= _steps.size()) {
 		if (ioCatchError(_writer->finish())) {
 			return;
+		} else if (!_stateFolder.isEmpty()) {
+			const auto result = Output::WriteExportedState(
+				_stateFolder,
+				_exportedState);
+			if (ioCatchError(result)) {
+				return;
+			}
 		}
 		_api.finishExport([=] {
 			setFinishedState();
@@ -360,6 +382,7 @@ void ControllerObject::collectDialogsList() {
 		return true;
 	}, [=](Data::DialogsInfo &&result) {
 		_dialogsInfo = std::move(result);
+		applyExportedState();
 		exportNext();
 	});
 }
@@ -448,9 +471,9 @@ void ControllerObject::exportNextDialog() {
 				return false;
 			}
 			_messagesWritten = 0;
-			_messagesCount = ranges::accumulate(
-				info.messagesCountPerSplit,
-				0);
+			_messagesCount = ranges::contains(info.messagesCountPerSplit, -1)
+				? -1
+				: ranges::accumulate(info.messagesCountPerSplit, 0);
 			setState(stateDialogs(DownloadProgress()));
 			return true;
 		}, [=](DownloadProgress progress) {
@@ -460,6 +483,7 @@ void ControllerObject::exportNextDialog() {
 			if (ioCatchError(_writer->writeDialogSlice(result))) {
 				return false;
 			}
+			rememberExported(result);
 			_messagesWritten += result.list.size();
 			setState(stateDialogs(DownloadProgress()));
 			return true;
@@ -477,6 +501,37 @@ void ControllerObject::exportNextDialog() {
 	exportNext();
 }
 
+void ControllerObject::applyExportedState() {
+	const auto &ids = _exportedState.lastMessageIds;
+	if (ids.empty()) {
+		return;
+	}
+	const auto apply = [&](std::vector<Data::DialogInfo> &list) {
+		for (auto &dialog : list) {
+			const auto i = ids.find(dialog.peerId);
+			if (i != end(ids)) {
+				dialog.exportedTillId = i->second;
+			}
+		}
+	};
+	apply(_dialogsInfo.chats);
+	apply(_dialogsInfo.left);
+}
+
+void ControllerObject::rememberExported(const Data::MessagesSlice &slice) {
+	if (_stateFolder.isEmpty()) {
+		return;
+	}
+	const auto info = _dialogsInfo.item(_dialogIndex);
+	Assert(info != nullptr);
+
+	auto &last = _exportedState.lastMessageIds[info->peerId];
+	for (const auto &message : slice.list) {
+		// Messages from before the migration have negative ids here.
+		last = std::max(last, message.id);
+	}
+}
+
 template <typename Callback>
 ProcessingState ControllerObject::prepareState(
 		Step step,
@@ -568,7 +623,9 @@ void ControllerObject::fillMessagesState(
 		? ProcessingState::EntityType::RepliesMessages
 		: ProcessingState::EntityType::Chat;
 	result.itemIndex = _messagesWritten + progress.itemIndex;
-	result.itemCount = std::max(_messagesCount, result.itemIndex);
+	result.itemCount = (_messagesCount < 0)
+		? 0 // Unknown in incremental mode, the total is hidden.
+		: std::max(_messagesCount, result.itemIndex);
 	result.bytesType = ProcessingState::FileType::File; // TODO
 	if (!progress.path.isEmpty()) {
 		const auto last = progress.path.lastIndexOf('/');
@@ -83,6 +83,9 @@ struct Settings {
 
 	TimeId availableAt = 0;
 
+	// Export only the messages that are newer than in the previous run.
+	bool incremental = false;
+
 	bool onlySinglePeer() const {
 		return singlePeer.type() != mtpc_inputPeerEmpty;
 	}
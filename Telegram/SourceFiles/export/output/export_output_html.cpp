@@ -14,12 +14,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <QtCore/QSize>
 #include <QtCore/QFile>
 #include <QtCore/QDateTime>
+#include <QtCore/QThread>
 
 namespace Export {
 namespace Output {
 namespace {
 
 constexpr auto kMessagesInFile = 1000;
+// Much less than the 100 messages in an API slice, so that a single
+// writeDialogSlice() call has several chunks to render in parallel.
+// Each chunk renders one extra message to join with the previous one.
+constexpr auto kMessagesInRenderChunk = 16;
 constexpr auto kPersonalUserpicSize = 90;
 constexpr auto kEntryUserpicSize = 48;
 constexpr auto kServiceMessagePhotoSize = 60;
@@ -544,9 +549,16 @@ public:
 	[[nodiscard]] QString relativePath(const QString &path) const;
 	[[nodiscard]] QString relativePath(const Data::File &file) const;
 
+	// Renders with the same context in another thread, can't write.
+	[[nodiscard]] std::unique_ptr<Wrap> renderer() const;
+
 	~Wrap();
 
 private:
+	struct RendererTag {
+	};
+	Wrap(const Wrap &other, RendererTag);
+
 	[[nodiscard]] QByteArray composeStart();
 	[[nodiscard]] QByteArray pushGenericListEntry(
 		const QString &link,
@@ -661,6 +673,17 @@ HtmlWriter::Wrap::Wrap(
 	_composedStart = composeStart();
 }
 
+HtmlWriter::Wrap::Wrap(const Wrap &other, RendererTag)
+: _file(QString(), nullptr)
+, _closed(true)
+, _base(other._base)
+, _context(other._context) {
+}
+
+auto HtmlWriter::Wrap::renderer() const -> std::unique_ptr<Wrap> {
+	return std::unique_ptr<Wrap>(new Wrap(*this, RendererTag()));
+}
+
 bool HtmlWriter::Wrap::empty() const {
 	return _file.empty();
 }
@@ -2381,19 +2404,20 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_chat != nullptr);
 	Expects(!data.list.empty());
 
-	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
-		return wrapMessageLink(messageId, text);
-	};
+	auto messages = std::vector<const Data::Message*>();
+	messages.reserve(data.list.size());
+	for (const auto &message : data.list) {
+		if (!Data::SkipMessageByDate(message, _settings)) {
+			messages.push_back(&message);
+		}
+	}
 	auto oldIndex = (_messagesCount > 0)
 		? ((_messagesCount - 1) / kMessagesInFile)
 		: 0;
 	auto previous = _lastMessageInfo.get();
 	auto saved = std::optional<MessageInfo>();
 	auto block = QByteArray();
-	for (const auto &message : data.list) {
-		if (Data::SkipMessageByDate(message, _settings)) {
-			continue;
-		}
+	for (auto from = 0, count = int(messages.size()); from != count;) {
 		const auto newIndex = (_messagesCount / kMessagesInFile);
 		if (oldIndex != newIndex) {
 			if (const auto result = _chat->writeBlock(block); !result) {
@@ -2418,27 +2442,32 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 			}
 			_chatFileEmpty = false;
 		}
-		const auto date = message.date;
-		if (DisplayDate(date, previous ? previous->date : 0)) {
-			block.append(_chat->pushServiceMessage(
-				--_dateMessageId,
-				_dialog,
-				_settings.path,
-				FormatDateText(date)));
-		}
-		const auto [info, content] = _chat->pushMessage(
-			message,
+
+		// Render all the messages that go to the current file at once.
+		const auto till = std::min(
+			count,
+			from + kMessagesInFile - (_messagesCount % kMessagesInFile));
+		auto rendered = renderMessages(
+			{ begin(messages) + from, begin(messages) + till },
 			previous,
-			_dialog,
-			_settings.path,
-			data.peers,
-			_environment.internalLinksDomain,
-			messageLinkWrapper);
-		block.append(content);
+			data.peers);
+		for (auto i = from; i != till; ++i) {
+			auto &[info, content] = rendered[i - from];
+			const auto date = messages[i]->date;
+			if (DisplayDate(date, previous ? previous->date : 0)) {
+				block.append(_chat->pushServiceMessage(
+					--_dateMessageId,
+					_dialog,
+					_settings.path,
+					FormatDateText(date)));
+			}
+			block.append(content);
 
-		++_messagesCount;
-		saved = info;
-		previous = &*saved;
+			++_messagesCount;
+			saved = std::move(info);
+			previous = &*saved;
+		}
+		from = till;
 	}
 	if (saved) {
 		_lastMessageInfo = std::make_unique<MessageInfo>(*saved);
@@ -2446,6 +2475,79 @@ Result HtmlWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	return block.isEmpty() ? Result::Success() : _chat->writeBlock(block);
 }
 
+auto HtmlWriter::renderMessages(
+	const std::vector<const Data::Message*> &messages,
+	const MessageInfo *previous,
+	const std::map<Data::PeerId, Data::Peer> &peers)
+-> std::vector<std::pair<MessageInfo, QByteArray>> {
+	const auto messageLinkWrapper = [&](int messageId, QByteArray text) {
+		return wrapMessageLink(messageId, text);
+	};
+	const auto count = int(messages.size());
+	const auto chunks = (count + kMessagesInRenderChunk - 1)
+		/ kMessagesInRenderChunk;
+	auto result = std::vector<std::pair<MessageInfo, QByteArray>>(count);
+	const auto render = [&](int chunk) {
+		const auto renderer = _chat->renderer();
+		const auto from = chunk * kMessagesInRenderChunk;
+		const auto till = std::min(from + kMessagesInRenderChunk, count);
+		const auto push = [&](int index, const MessageInfo *previous) {
+			return renderer->pushMessage(
+				*messages[index],
+				previous,
+				_dialog,
+				_settings.path,
+				peers,
+				_environment.internalLinksDomain,
+				messageLinkWrapper);
+		};
+
+		// Info doesn't depend on the previous message, so the chunk
+		// can render the message before it to know how to join them.
+		auto first = std::optional<MessageInfo>();
+		if (from > 0) {
+			first = push(from - 1, nullptr).first;
+		}
+		auto last = first ? &*first : previous;
+		for (auto i = from; i != till; ++i) {
+			result[i] = push(i, last);
+			last = &result[i].first;
+		}
+	};
+
+	// Chunks are taken both by this thread and by the async workers,
+	// so we wait only for the chunks the workers have already taken.
+	// Workers that start later find nothing to do and don't touch
+	// anything except the shared state.
+	struct Shared {
+		std::atomic<int> next = 0;
+		crl::semaphore finished;
+	};
+	const auto shared = std::make_shared<Shared>();
+	const auto workers = std::min(
+		chunks - 1,
+		std::max(QThread::idealThreadCount() - 1, 0));
+	for (auto i = 0; i < workers; ++i) {
+		crl::async([=, &render] {
+			for (auto chunk = shared->next++; chunk < chunks;) {
+				render(chunk);
+				chunk = shared->next++;
+				shared->finished.release();
+			}
+		});
+	}
+	auto renderedHere = 0;
+	for (auto chunk = shared->next++; chunk < chunks;) {
+		render(chunk);
+		++renderedHere;
+		chunk = shared->next++;
+	}
+	for (auto i = renderedHere; i != chunks; ++i) {
+		shared->finished.acquire();
+	}
+	return result;
+}
+
 Result HtmlWriter::writeEmptySinglePeer() {
 	Expects(_chat != nullptr);
 
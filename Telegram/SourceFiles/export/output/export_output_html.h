@@ -131,6 +131,11 @@ private:
 	[[nodiscard]] QByteArray wrapMessageLink(
 		int messageId,
 		QByteArray text);
+	[[nodiscard]] auto renderMessages(
+		const std::vector<const Data::Message*> &messages,
+		const MessageInfo *previous,
+		const std::map<Data::PeerId, Data::Peer> &peers)
+	-> std::vector<std::pair<MessageInfo, QByteArray>>;
 
 	Settings _settings;
 	Environment _environment;
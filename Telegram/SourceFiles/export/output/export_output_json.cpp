@@ -23,49 +23,76 @@ namespace {
 
 using Context = details::JsonContext;
 
-QByteArray SerializeString(const QByteArray &value) {
-	const auto size = value.size();
+constexpr auto kDialogSliceReserve = 64 * 1024;
+
+// Bytes that can be copied to the output as is.
+constexpr auto kPlainBytes = [] {
+	auto result = std::array<bool, 256>();
+	for (auto i = 0; i != 256; ++i) {
+		result[i] = (i >= 32 && i != '"' && i != '\\' && i != 0xE2);
+	}
+	return result;
+}();
+
+void AppendString(QByteArray &to, const QByteArray &value) {
 	const auto begin = value.data();
-	const auto end = begin + size;
+	const auto end = begin + value.size();
+	const auto plain = [](char ch) {
+		return kPlainBytes[uchar(ch)];
+	};
 
-	auto result = QByteArray();
-	result.reserve(2 + size * 4);
-	result.append('"');
-	for (auto p = begin; p != end; ++p) {
-		const auto ch = *p;
+	to.append('"');
+	for (auto p = begin; p != end;) {
+		const auto from = p;
+		while (p != end && plain(*p)) {
+			++p;
+		}
+		if (p != from) {
+			to.append(from, p - from);
+			if (p == end) {
+				break;
+			}
+		}
+		const auto ch = *p++;
 		if (ch == '\n') {
-			result.append("\\n", 2);
+			to.append("\\n", 2);
 		} else if (ch == '\r') {
-			result.append("\\r", 2);
+			to.append("\\r", 2);
 		} else if (ch == '\t') {
-			result.append("\\t", 2);
+			to.append("\\t", 2);
 		} else if (ch == '"') {
-			result.append("\\\"", 2);
+			to.append("\\\"", 2);
 		} else if (ch == '\\') {
-			result.append("\\\\", 2);
+			to.append("\\\\", 2);
 		} else if (ch >= 0 && ch < 32) {
-			result.append("\\x", 2).append('0' + (ch >> 4));
+			to.append("\\x", 2).append('0' + (ch >> 4));
 			const auto left = (ch & 0x0F);
 			if (left >= 10) {
-				result.append('A' + (left - 10));
+				to.append('A' + (left - 10));
 			} else {
-				result.append('0' + left);
+				to.append('0' + left);
 			}
 		} else if (ch == char(0xE2)
-			&& (p + 2 < end)
-			&& *(p + 1) == char(0x80)) {
-			if (*(p + 2) == char(0xA8)) { // Line separator.
-				result.append("\\u2028", 6);
-			} else if (*(p + 2) == char(0xA9)) { // Paragraph separator.
-				result.append("\\u2029", 6);
+			&& (p + 1 < end)
+			&& *p == char(0x80)) {
+			if (*(p + 1) == char(0xA8)) { // Line separator.
+				to.append("\\u2028", 6);
+			} else if (*(p + 1) == char(0xA9)) { // Paragraph separator.
+				to.append("\\u2029", 6);
 			} else {
-				result.append(ch);
+				to.append(ch);
 			}
 		} else {
-			result.append(ch);
+			to.append(ch);
 		}
 	}
-	result.append('"');
+	to.append('"');
+}
+
+QByteArray SerializeString(const QByteArray &value) {
+	auto result = QByteArray();
+	result.reserve(value.size() + 2);
+	AppendString(result, value);
 	return result;
 }
 
@@ -90,17 +117,30 @@ QByteArray Indentation(const Context &context) {
 	return Indentation(context.nesting.size());
 }
 
-QByteArray SerializeObject(
+void AppendIndentation(QByteArray &to, int size) {
+	to.append(size, ' ');
+}
+
+void AppendObject(
+		QByteArray &result,
 		Context &context,
 		const std::vector<std::pair<QByteArray, QByteArray>> &values) {
-	const auto indent = Indentation(context);
+	const auto indent = int(context.nesting.size());
+	const auto next = indent + 1;
 
-	context.nesting.push_back(Context::kObject);
-	const auto guard = gsl::finally([&] { context.nesting.pop_back(); });
-	const auto next = '\n' + Indentation(context);
+	// Keys are short and mostly don't need escaping, reserve it all.
+	auto size = 2 + 1 + indent;
+	for (const auto &[key, value] : values) {
+		if (!value.isEmpty()) {
+			size += 2 + next + key.size() + 4 + value.size();
+		}
+	}
 
+	// Appending to a larger buffer relies on its own growth instead.
 	auto first = true;
-	auto result = QByteArray();
+	if (result.isEmpty()) {
+		result.reserve(size);
+	}
 	result.append('{');
 	for (const auto &[key, value] : values) {
 		if (value.isEmpty()) {
@@ -111,21 +151,38 @@ QByteArray SerializeObject(
 		} else {
 			result.append(',');
 		}
-		result.append(next).append(SerializeString(key)).append(": ", 2);
-		result.append(value);
+		result.append('\n');
+		AppendIndentation(result, next);
+		AppendString(result, key);
+		result.append(": ", 2).append(value);
 	}
-	result.append('\n').append(indent).append("}");
+	result.append('\n');
+	AppendIndentation(result, indent);
+	result.append('}');
+}
+
+QByteArray SerializeObject(
+		Context &context,
+		const std::vector<std::pair<QByteArray, QByteArray>> &values) {
+	auto result = QByteArray();
+	AppendObject(result, context, values);
 	return result;
 }
 
 QByteArray SerializeArray(
 		Context &context,
 		const std::vector<QByteArray> &values) {
-	const auto indent = Indentation(context.nesting.size());
-	const auto next = '\n' + Indentation(context.nesting.size() + 1);
+	const auto indent = int(context.nesting.size());
+	const auto next = indent + 1;
+
+	auto size = 2 + 1 + indent;
+	for (const auto &value : values) {
+		size += 2 + next + value.size();
+	}
 
 	auto first = true;
 	auto result = QByteArray();
+	result.reserve(size);
 	result.append('[');
 	for (const auto &value : values) {
 		if (first) {
@@ -133,9 +190,13 @@ QByteArray SerializeArray(
 		} else {
 			result.append(',');
 		}
-		result.append(next).append(value);
+		result.append('\n');
+		AppendIndentation(result, next);
+		result.append(value);
 	}
-	result.append('\n').append(indent).append("]");
+	result.append('\n');
+	AppendIndentation(result, indent);
+	result.append(']');
 	return result;
 }
 
@@ -146,6 +207,8 @@ QByteArray SerializeText(
 
 	if (data.empty()) {
 		return SerializeString("");
+	} else if (data.size() == 1 && data[0].type == Type::Text) {
+		return SerializeString(data[0].text);
 	}
 
 	context.nesting.push_back(Context::kArray);
@@ -200,9 +263,6 @@ QByteArray SerializeText(
 
 	context.nesting.pop_back();
 
-	if (data.size() == 1 && data[0].type == Data::TextPart::Type::Text) {
-		return text[0];
-	}
 	return SerializeArray(context, text);
 }
 
@@ -214,7 +274,8 @@ QByteArray FormatFilePath(const Data::File &file) {
 	return file.relativePath.toUtf8();
 }
 
-QByteArray SerializeMessage(
+void AppendMessage(
+		QByteArray &to,
 		Context &context,
 		const Data::Message &message,
 		const std::map<Data::PeerId, Data::Peer> &peers,
@@ -222,10 +283,11 @@ QByteArray SerializeMessage(
 	using namespace Data;
 
 	if (v::is<UnsupportedMedia>(message.media.content)) {
-		return SerializeObject(context, {
+		AppendObject(to, context, {
 			{ "id", Data::NumberToString(message.id) },
 			{ "type", SerializeString("unsupported") }
 		});
+		return;
 	}
 
 	const auto peer = [&](PeerId peerId) -> const Peer& {
@@ -261,10 +323,6 @@ QByteArray SerializeMessage(
 	{ "date", SerializeDate(message.date) },
 	};
 	context.nesting.push_back(Context::kObject);
-	const auto serialized = [&] {
-		context.nesting.pop_back();
-		return SerializeObject(context, values);
-	};
 
 	const auto pushBare = [&](
 			const QByteArray &key,
@@ -642,7 +700,8 @@ QByteArray SerializeMessage(
 
 	pushBare("text", SerializeText(context, message.text));
 
-	return serialized();
+	context.nesting.pop_back();
+	AppendObject(to, context, values);
 }
 
 } // namespace
@@ -684,8 +743,19 @@ QByteArray JsonWriter::prepareObjectItemStart(const QByteArray &key) {
 }
 
 QByteArray JsonWriter::prepareArrayItemStart() {
-	const auto guard = gsl::finally([&] { _currentNestingHadItem = true; });
-	return (_currentNestingHadItem ? ",\n" : "\n") + Indentation(_context);
+	auto result = QByteArray();
+	appendArrayItemStart(result);
+	return result;
+}
+
+void JsonWriter::appendArrayItemStart(QByteArray &to) {
+	if (_currentNestingHadItem) {
+		to.append(",\n", 2);
+	} else {
+		to.append('\n');
+		_currentNestingHadItem = true;
+	}
+	AppendIndentation(to, int(_context.nesting.size()));
 }
 
 QByteArray JsonWriter::popNesting() {
@@ -1086,18 +1156,24 @@ Result JsonWriter::validateDialogsMode(bool isLeftChannel) {
 Result JsonWriter::writeDialogSlice(const Data::MessagesSlice &data) {
 	Expects(_output != nullptr);
 
-	auto block = QByteArray();
+	// Reuse the allocation between slices, reserve() keeps it on resize.
+	if (!_block.capacity()) {
+		_block.reserve(kDialogSliceReserve);
+	}
+	_block.resize(0);
 	for (const auto &message : data.list) {
 		if (Data::SkipMessageByDate(message, _settings)) {
 			continue;
 		}
-		block.append(prepareArrayItemStart() + SerializeMessage(
+		appendArrayItemStart(_block);
+		AppendMessage(
+			_block,
 			_context,
 			message,
 			data.peers,
-			_environment.internalLinksDomain));
+			_environment.internalLinksDomain);
 	}
-	return block.isEmpty() ? Result::Success() : _output->writeBlock(block);
+	return _block.isEmpty() ? Result::Success() : _output->writeBlock(_block);
 }
 
 Result JsonWriter::writeDialogEnd() {
@@ -71,6 +71,7 @@ private:
 	[[nodiscard]] QByteArray pushNesting(Context::Type type);
 	[[nodiscard]] QByteArray prepareObjectItemStart(const QByteArray &key);
 	[[nodiscard]] QByteArray prepareArrayItemStart();
+	void appendArrayItemStart(QByteArray &to);
 	[[nodiscard]] QByteArray popNesting();
 
 	[[nodiscard]] QString mainFileRelativePath() const;
@@ -99,6 +100,7 @@ private:
 	DialogsMode _dialogsMode = DialogsMode::None;
 
 	std::unique_ptr<File> _output;
+	QByteArray _block;
 
 };
 
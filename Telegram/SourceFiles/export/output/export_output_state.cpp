@@ -0,0 +1,81 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/output/export_output_state.h"
+
+#include "export/output/export_output_file.h"
+#include "export/output/export_output_result.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+
+namespace Export {
+namespace Output {
+namespace {
+
+constexpr auto kStateVersion = 1;
+
+[[nodiscard]] QString StatePath(const QString &folder) {
+	Expects(folder.endsWith('/'));
+
+	return folder + "export_state.json";
+}
+
+} // namespace
+
+ExportedState ReadExportedState(const QString &folder) {
+	auto file = QFile(StatePath(folder));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return ExportedState();
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+	if (error.error != QJsonParseError::NoError || !document.isObject()) {
+		LOG(("Export Error: Bad state file '%1'.").arg(file.fileName()));
+		return ExportedState();
+	}
+	const auto root = document.object();
+	if (root.value("version").toInt() != kStateVersion) {
+		return ExportedState();
+	}
+	auto result = ExportedState();
+	for (const auto &value : root.value("dialogs").toArray()) {
+		const auto dialog = value.toObject();
+		const auto peerId = dialog.value("peer_id").toString().toULongLong();
+		const auto messageId = dialog.value("last_message_id").toInt();
+		if (peerId && messageId > 0) {
+			result.lastMessageIds.emplace(peerId, messageId);
+		}
+	}
+	return result;
+}
+
+Result WriteExportedState(
+		const QString &folder,
+		const ExportedState &state) {
+	auto dialogs = QJsonArray();
+	for (const auto &[peerId, messageId] : state.lastMessageIds) {
+		if (messageId <= 0) {
+			continue;
+		}
+		auto dialog = QJsonObject();
+		dialog.insert("peer_id", QString::number(peerId));
+		dialog.insert("last_message_id", messageId);
+		dialogs.append(dialog);
+	}
+	auto root = QJsonObject();
+	root.insert("version", kStateVersion);
+	root.insert("dialogs", dialogs);
+
+	// A new File truncates the existing one before the first write.
+	return File(StatePath(folder), nullptr).writeBlock(
+		QJsonDocument(root).toJson());
+}
+
+} // namespace Output
+} // namespace Export
@@ -0,0 +1,29 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "export/data/export_data_types.h"
+#include "base/flat_map.h"
+
+namespace Export {
+namespace Output {
+
+struct Result;
+
+// Kept in the export folder between the runs of the incremental export.
+struct ExportedState {
+	base::flat_map<Data::PeerId, int32> lastMessageIds;
+};
+
+[[nodiscard]] ExportedState ReadExportedState(const QString &folder);
+[[nodiscard]] Result WriteExportedState(
+	const QString &folder,
+	const ExportedState &state);
+
+} // namespace Output
+} // namespace Export
@@ -84,6 +84,7 @@ private:
 	void addSizeSlider(not_null<Ui::VerticalLayout*> container);
 	void addLocationLabel(
 		not_null<Ui::VerticalLayout*> container);
+	void addIncrementalOption(not_null<Ui::VerticalLayout*> container);
 	void addFormatAndLocationLabel(
 		not_null<Ui::VerticalLayout*> container);
 	void addLimitsLabel(
@@ -31,6 +31,12 @@ constexpr auto kAvioBlockSize = 4096;
 constexpr auto kTimeUnknown = std::numeric_limits<crl::time>::min();
 constexpr auto kDurationMax = crl::time(std::numeric_limits<int>::max());
 
+// Smaller videos are decoded in one thread, there may be many of them.
+constexpr auto kMinThreadedFrameArea = 640 * 360;
+
+// Frames shown at half of the original size or less skip the loop filter.
+constexpr auto kPreviewAreaRatio = 4;
+
 void AlignedImageBufferCleanupHandler(void* data) {
 	const auto buffer = static_cast<uchar*>(data);
 	delete[] buffer;
@@ -175,7 +181,7 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 		return {};
 	}
 	context->pkt_timebase = stream->time_base;
-	av_opt_set(context, "threads", "auto", 0);
+	ApplyDecoderThreads(context);
 	av_opt_set_int(context, "refcounted_frames", 1, 0);
 
 	const auto codec = avcodec_find_decoder(context->codec_id);
@@ -189,6 +195,31 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 	return result;
 }
 
+DecoderProfile ChooseDecoderProfile(QSize frame, QSize shown) {
+	const auto frameArea = frame.width() * frame.height();
+	const auto shownArea = shown.width() * shown.height();
+	return (!shown.isEmpty() && shownArea * kPreviewAreaRatio <= frameArea)
+		? DecoderProfile::Preview
+		: DecoderProfile::Full;
+}
+
+void ApplyDecoderThreads(not_null<AVCodecContext*> context) {
+	if (context->width * context->height < kMinThreadedFrameArea) {
+		context->thread_count = 1;
+	} else {
+		context->thread_count = 0; // Automatic.
+		context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+	}
+}
+
+void ApplyDecoderProfile(
+		not_null<AVCodecContext*> context,
+		DecoderProfile profile) {
+	context->skip_loop_filter = (profile == DecoderProfile::Preview)
+		? AVDISCARD_ALL
+		: AVDISCARD_DEFAULT;
+}
+
 void CodecDeleter::operator()(AVCodecContext *value) {
 	if (value) {
 		avcodec_free_context(&value);
@@ -139,6 +139,20 @@ struct CodecDeleter {
 using CodecPointer = std::unique_ptr<AVCodecContext, CodecDeleter>;
 [[nodiscard]] CodecPointer MakeCodecPointer(not_null<AVStream*> stream);
 
+enum class DecoderProfile {
+	Full,
+	Preview, // Frames are shown much smaller, quality may be lower.
+};
+[[nodiscard]] DecoderProfile ChooseDecoderProfile(QSize frame, QSize shown);
+
+// Must be called before avcodec_open2, chooses threading by frame size.
+void ApplyDecoderThreads(not_null<AVCodecContext*> context);
+
+// May be called for an opened decoder, applies to the next frames.
+void ApplyDecoderProfile(
+	not_null<AVCodecContext*> context,
+	DecoderProfile profile);
+
 struct FrameDeleter {
 	void operator()(AVFrame *value);
 };
@@ -154,6 +154,12 @@ HistoryInner::HistoryInner(
 , _peer(history->peer)
 , _history(history)
 , _migrated(history->migrateFrom())
+, _repaints(this, [=] {
+	return HistoryView::RepaintCoalescer::VisibleRange{
+		_visibleAreaTop,
+		_visibleAreaBottom,
+	};
+})
 , _scrollDateCheck([this] { scrollDateCheck(); })
 , _scrollDateHideTimer([this] { scrollDateHideByTimer(); }) {
 	Instance = this;
@@ -259,7 +265,7 @@ void HistoryInner::repaintItem(const Element *view) {
 	const auto top = itemTop(view);
 	if (top >= 0) {
 		const auto range = view->verticalRepaintRange();
-		update(0, top + range.top, width(), range.height);
+		_repaints.request(top + range.top, range.height);
 	}
 }
 
@@ -2387,6 +2393,7 @@ void HistoryInner::updateSize() {
 	} else {
 		update();
 	}
+	_repaints.layoutChanged();
 }
 
 void HistoryInner::enterEventHook(QEvent *e) {
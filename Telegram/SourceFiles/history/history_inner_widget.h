@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/widgets/tooltip.h"
 #include "ui/widgets/scroll_area.h"
 #include "history/view/history_view_top_bar_widget.h"
+#include "history/view/history_view_repaint_coalescer.h"
 
 namespace Data {
 struct Group;
@@ -339,6 +340,7 @@ private:
 	// Save visible area coords for painting / pressing userpics.
 	int _visibleAreaTop = 0;
 	int _visibleAreaBottom = 0;
+	HistoryView::RepaintCoalescer _repaints;
 
 	// With migrated history we perhaps do not need to display
 	// the first _history message date (just skip it by height).
@@ -251,6 +251,9 @@ ListWidget::ListWidget(
 , _controller(controller)
 , _context(_delegate->listContext())
 , _itemAverageHeight(itemMinimalHeight())
+, _repaints(this, [=] {
+	return RepaintCoalescer::VisibleRange{ _visibleTop, _visibleBottom };
+})
 , _scrollDateCheck([this] { scrollDateCheck(); })
 , _applyUpdatedScrollState([this] { applyUpdatedScrollState(); })
 , _selectEnabled(_delegate->listAllowsMultiSelect())
@@ -1373,6 +1376,7 @@ void ListWidget::resizeToWidth(int newWidth, int minHeight) {
 
 int ListWidget::resizeGetHeight(int newWidth) {
 	update();
+	_repaints.layoutChanged();
 
 	const auto resizeAllItems = (_itemsWidth != newWidth);
 	auto newHeight = 0;
@@ -2582,7 +2586,7 @@ void ListWidget::repaintItem(const Element *view) {
 	}
 	const auto top = itemTop(view);
 	const auto range = view->verticalRepaintRange();
-	update(0, top + range.top, width(), range.height);
+	_repaints.request(top + range.top, range.height);
 }
 
 void ListWidget::repaintItem(FullMsgId itemId) {
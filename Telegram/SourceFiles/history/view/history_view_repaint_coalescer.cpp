@@ -0,0 +1,78 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "history/view/history_view_repaint_coalescer.h"
+
+namespace HistoryView {
+
+RepaintCoalescer::RepaintCoalescer(
+	not_null<QWidget*> widget,
+	Fn<VisibleRange()> visibleRange)
+: _widget(widget)
+, _visibleRange(std::move(visibleRange)) {
+}
+
+RepaintCoalescer::~RepaintCoalescer() {
+	if (_dropped > 0) {
+		DEBUG_LOG(("Repaint Info: %1 repaint requests out of view dropped."
+			).arg(_dropped));
+	}
+}
+
+void RepaintCoalescer::request(int top, int height) {
+	if (height <= 0) {
+		return;
+	}
+	const auto bottom = top + height;
+	const auto visible = _visibleRange();
+
+	// Empty visible range means we don't know it yet.
+	if (visible.bottom > visible.top
+		&& (bottom <= visible.top || top >= visible.bottom)) {
+		++_dropped;
+		return;
+	}
+	auto row = Row{ top, bottom };
+	for (auto i = begin(_rows); i != end(_rows);) {
+		if (i->bottom < row.top || i->top > row.bottom) {
+			++i;
+			continue;
+		}
+		row.top = std::min(row.top, i->top);
+		row.bottom = std::max(row.bottom, i->bottom);
+		i = _rows.erase(i);
+	}
+	_rows.push_back(row);
+	schedule();
+}
+
+void RepaintCoalescer::schedule() {
+	if (_scheduled) {
+		return;
+	}
+	_scheduled = true;
+	crl::on_main(this, [=] {
+		if (_scheduled) {
+			flush();
+		}
+	});
+}
+
+void RepaintCoalescer::flush() {
+	_scheduled = false;
+	const auto width = _widget->width();
+	for (const auto &row : base::take(_rows)) {
+		_widget->update(0, row.top, width, row.bottom - row.top);
+	}
+}
+
+void RepaintCoalescer::layoutChanged() {
+	_scheduled = false;
+	_rows.clear();
+}
+
+} // namespace HistoryView
@@ -0,0 +1,52 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+namespace HistoryView {
+
+// Collects full-width rows requested for repaint and updates the widget
+// on the next event loop iteration, merging overlapping rows and
+// dropping the ones outside of the visible area.
+class RepaintCoalescer final : public base::has_weak_ptr {
+public:
+	struct VisibleRange {
+		int top = 0;
+		int bottom = 0;
+	};
+
+	RepaintCoalescer(
+		not_null<QWidget*> widget,
+		Fn<VisibleRange()> visibleRange);
+	~RepaintCoalescer();
+
+	void request(int top, int height);
+	void flush();
+
+	// The widget was relaid out and updated as a whole,
+	// the queued rows are in the old coordinates.
+	void layoutChanged();
+
+private:
+	struct Row {
+		int top = 0;
+		int bottom = 0;
+	};
+
+	void schedule();
+
+	const not_null<QWidget*> _widget;
+	const Fn<VisibleRange()> _visibleRange;
+	std::vector<Row> _rows;
+	bool _scheduled = false;
+	int _dropped = 0;
+
+};
+
+} // namespace HistoryView
@@ -69,11 +69,17 @@ void PaintWaveform(
 		bool selected,
 		bool outbg,
 		float64 progress) {
+	const auto counting = voiceData
+		&& !voiceData->waveform.isEmpty()
+		&& (voiceData->waveform.at(0) == -1)
+		&& !voiceData->partialWaveform.isEmpty();
 	const auto wf = [&]() -> const VoiceWaveform* {
 		if (!voiceData) {
 			return nullptr;
 		}
-		if (voiceData->waveform.isEmpty()) {
+		if (counting) {
+			return &voiceData->partialWaveform;
+		} else if (voiceData->waveform.isEmpty()) {
 			return nullptr;
 		} else if (voiceData->waveform.at(0) < 0) {
 			return nullptr;
@@ -105,7 +111,11 @@ void PaintWaveform(
 	const auto barCount = std::min(
 		availableWidth / (barWidth + st::msgWaveformSkip),
 		wfSize);
-	const auto barNormValue = (wf ? voiceData->wavemax : 0) + 1;
+	const auto barNormValue = (!wf
+		? 0
+		: counting
+		? voiceData->partialWavemax
+		: voiceData->wavemax) + 1;
 	const auto maxDelta = st::msgWaveformMax - st::msgWaveformMin;
 	const auto &bottom = st::msgWaveformMax;
 	p.setPen(Qt::NoPen);
@@ -66,6 +66,14 @@ UniversalMsgId GetUniversalId(not_null<const BaseLayout*> layout) {
 	return GetUniversalId(layout->getItem()->fullId());
 }
 
+void ResizeItem(not_null<BaseLayout*> item, int width) {
+	// Layouts limit their width by maxWidth() and their height depends
+	// only on the width, so the ones already laid out can be skipped.
+	if (!item->width() || item->width() != std::min(width, item->maxWidth())) {
+		item->resizeGetHeight(width);
+	}
+}
+
 } // namespace
 
 struct ListWidget::Context {
@@ -459,7 +467,7 @@ void ListWidget::Section::resizeToWidth(int newWidth) {
 		_itemsInRow = 1;
 		_itemWidth = itemWidth;
 		for (auto &item : _items) {
-			item.second->resizeGetHeight(_itemWidth);
+			ResizeItem(item.second, _itemWidth);
 		}
 	};
 	switch (_type) {
@@ -473,7 +481,7 @@ void ListWidget::Section::resizeToWidth(int newWidth) {
 		_itemWidth = ((newWidth - _itemsLeft) / _itemsInRow)
 			- st::infoMediaSkip;
 		for (auto &item : _items) {
-			item.second->resizeGetHeight(_itemWidth);
+			ResizeItem(item.second, _itemWidth);
 		}
 	} break;
 
@@ -607,6 +615,13 @@ void ListWidget::start() {
 		repaintItem(item);
 	}, lifetime());
 
+	shownValue(
+	) | rpl::start_with_next([=](bool shown) {
+		if (!shown) {
+			clearStaleLayouts();
+		}
+	}, lifetime());
+
 	_controller->mediaSourceQueryValue(
 	) | rpl::start_with_next([this]{
 		restart();
@@ -980,8 +995,12 @@ void ListWidget::refreshRows() {
 }
 
 void ListWidget::markLayoutsStale() {
-	for (auto &layout : _layouts) {
-		layout.second.stale = true;
+	++_staleIndex;
+	for (auto &[id, layout] : _layouts) {
+		if (!layout.stale) {
+			layout.stale = true;
+			layout.staleIndex = _staleIndex;
+		}
 	}
 }
 
@@ -1838,7 +1857,9 @@ void ListWidget::updateDragSelection() {
 	for (auto &layoutItem : _layouts) {
 		auto &&universalId = layoutItem.first;
 		auto &&layout = layoutItem.second;
-		if (universalId <= fromId && universalId > tillId) {
+		if (layout.stale) {
+			continue;
+		} else if (universalId <= fromId && universalId > tillId) {
 			changeItemSelection(
 				_dragSelected,
 				universalId,
@@ -2168,12 +2189,34 @@ void ListWidget::mouseActionUpdate() {
 }
 
 void ListWidget::clearStaleLayouts() {
+	// Layouts that left the loaded slice most recently are kept without
+	// their heavy parts, so that scrolling back doesn't recreate them.
+	auto kept = std::vector<int>();
+	for (auto &[id, layout] : _layouts) {
+		if (!layout.stale) {
+			continue;
+		}
+		const auto item = layout.item.get();
+		if (item == _overLayout) {
+			_overLayout = nullptr;
+		}
+		if (_heavyLayouts.contains(item)) {
+			_heavyLayouts.remove(item);
+			item->clearHeavyPart();
+		}
+		kept.push_back(layout.staleIndex);
+	}
+	const auto limit = staleLayoutsLimit();
+	if (int(kept.size()) <= limit) {
+		return;
+	}
+	const auto border = kept.end() - limit;
+	ranges::nth_element(kept, border);
+	const auto minKeptIndex = (border != kept.end())
+		? *border
+		: (_staleIndex + 1);
 	for (auto i = _layouts.begin(); i != _layouts.end();) {
-		if (i->second.stale) {
-			if (i->second.item.get() == _overLayout) {
-				_overLayout = nullptr;
-			}
-			_heavyLayouts.erase(i->second.item.get());
+		if (i->second.stale && i->second.staleIndex < minKeptIndex) {
 			i = _layouts.erase(i);
 		} else {
 			++i;
@@ -2181,6 +2224,16 @@ void ListWidget::clearStaleLayouts() {
 	}
 }
 
+int ListWidget::staleLayoutsLimit() const {
+	// About one screen of items, enough to scroll back over the slice
+	// border without recreating them. Nothing is kept while hidden.
+	const auto visibleHeight = _visibleBottom - _visibleTop;
+	if (isHidden() || visibleHeight <= 0 || width() <= 0) {
+		return 0;
+	}
+	return visibleHeight / Section::MinItemHeight(_type, width()) + 1;
+}
+
 auto ListWidget::findSectionByItem(
 		UniversalMsgId universalId) -> std::vector<Section>::iterator {
 	return ranges::lower_bound(
@@ -99,6 +99,7 @@ private:
 		~CachedItem();
 
 		std::unique_ptr<BaseLayout> item;
+		int staleIndex = 0;
 		bool stale = false;
 	};
 	struct FoundItem {
@@ -233,6 +234,7 @@ private:
 
 	void markLayoutsStale();
 	void clearStaleLayouts();
+	[[nodiscard]] int staleLayoutsLimit() const;
 	std::vector<Section>::iterator findSectionByItem(
 		UniversalMsgId universalId);
 	std::vector<Section>::iterator findSectionAfterTop(int top);
@@ -291,6 +293,7 @@ private:
 	SparseIdsMergedSlice _slice;
 
 	std::unordered_map<UniversalMsgId, CachedItem> _layouts;
+	int _staleIndex = 0;
 	base::flat_set<not_null<const BaseLayout*>> _heavyLayouts;
 	bool _heavyLayoutsInvalidated = false;
 	std::vector<Section> _sections;
@@ -152,14 +152,13 @@ void PhoneWidget::submit() {
 	const auto phoneDigits = digitsOnly(phone);
 	for (const auto &[index, existing] : Core::App().domain().accounts()) {
 		const auto raw = existing.get();
-		if (const auto session = raw->maybeSession()) {
-			if (raw->mtp().environment() == account().mtp().environment()
-				&& digitsOnly(session->user()->phone()) == phoneDigits) {
-				crl::on_main(raw, [=] {
-					Core::App().domain().activate(raw);
-				});
-				return;
-			}
+		if (raw->authorized()
+			&& raw->mtp().environment() == account().mtp().environment()
+			&& digitsOnly(raw->authorizedPhone()) == phoneDigits) {
+			crl::on_main(raw, [=] {
+				Core::App().domain().activate(raw);
+			});
+			return;
 		}
 	}
 
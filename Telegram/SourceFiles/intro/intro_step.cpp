@@ -151,15 +151,14 @@ void Step::finish(const MTPUser &user, QImage &&photo) {
 	// Check if such account is authorized already.
 	for (const auto &[index, existing] : Core::App().domain().accounts()) {
 		const auto raw = existing.get();
-		if (const auto session = raw->maybeSession()) {
-			if (raw->mtp().environment() == _account->mtp().environment()
-				&& user.c_user().vid().v == session->userId()) {
-				_account->logOut();
-				crl::on_main(raw, [=] {
-					Core::App().domain().activate(raw);
-				});
-				return;
-			}
+		if (raw->authorized()
+			&& raw->mtp().environment() == _account->mtp().environment()
+			&& user.c_user().vid().v == raw->authorizedUserId()) {
+			_account->logOut();
+			crl::on_main(raw, [=] {
+				Core::App().domain().activate(raw);
+			});
+			return;
 		}
 	}
 
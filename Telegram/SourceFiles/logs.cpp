@@ -11,10 +11,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_reports.h"
 #include "core/launcher.h"
 
+#include <QtCore/QSemaphore>
+
 namespace {
 
 std::atomic<int> ThreadCounter/* = 0*/;
 
+// Lines are written in batches, the files are flushed after each batch.
+constexpr auto kFlushTimeout = 100; // ms
+
 } // namespace
 
 enum LogDataType {
@@ -26,17 +31,6 @@ enum LogDataType {
 	LogDataCount
 };
 
-QMutex *_logsMutex(LogDataType type, bool clear = false) {
-	static QMutex *LogsMutexes = 0;
-	if (clear) {
-		delete[] LogsMutexes;
-		LogsMutexes = 0;
-	} else if (!LogsMutexes) {
-		LogsMutexes = new QMutex[LogDataCount];
-	}
-	return &LogsMutexes[type];
-}
-
 QString _logsFilePath(LogDataType type, const QString &postfix = QString()) {
 	QString path(cWorkingDir());
 	switch (type) {
@@ -65,14 +59,24 @@ public:
 		for (int32 i = 0; i < LogDataCount; ++i) {
 			files[i].reset(new QFile());
 		}
+		_writer = std::thread([=] { runWriter(); });
+	}
+
+	~LogsDataFields() {
+		_stopping = true;
+		_wakeup.release();
+		_writer.join();
 	}
 
 	bool openMain() {
+		QMutexLocker lock(&_filesMutex);
 		return reopen(LogDataMain, 0, qsl("start"));
 	}
 
 	void closeMain() {
-		QMutexLocker lock(_logsMutex(LogDataMain));
+		QMutexLocker lock(&_filesMutex);
+		writePending();
+		QMutexLocker mainLock(&_mainMutex);
 		const auto file = files[LogDataMain].get();
 		if (file && file->isOpen()) {
 			file->close();
@@ -80,10 +84,14 @@ public:
 	}
 
 	bool instanceChecked() {
+		QMutexLocker lock(&_filesMutex);
+		writePending();
 		return reopen(LogDataMain, 0, QString());
 	}
 
 	QString full() {
+		QMutexLocker lock(&_filesMutex);
+		writePending();
 		const auto file = files[LogDataMain].get();
 		if (!!file || !file->isOpen()) {
 			return QString();
@@ -96,24 +104,104 @@ public:
 		return QString();
 	}
 
-	void write(LogDataType type, const QString &msg) {
-		QMutexLocker lock(_logsMutex(type));
-		if (type != LogDataMain) {
-			reopenDebug();
+	// Thread: Any. Lock-free for the debug logs, the line is encoded and
+	// written by the writer. The main log is written and flushed right
+	// away, so that its lines are on disk if the app crashes.
+	void write(LogDataType type, QString &&msg) {
+		if (type == LogDataMain) {
+			QMutexLocker lock(&_mainMutex);
+			const auto file = files[LogDataMain].get();
+			if (file && file->isOpen()) {
+				file->write(msg.toUtf8());
+				file->flush();
+			}
+			return;
+		}
+		const auto entry = new Entry{ type, std::move(msg) };
+		entry->next = _pending.load(std::memory_order_relaxed);
+		while (!_pending.compare_exchange_weak(
+			entry->next,
+			entry,
+			std::memory_order_release,
+			std::memory_order_relaxed)) {
+		}
+		if (!entry->next) {
+			_wakeup.release();
+		}
+	}
+
+private:
+	struct Entry {
+		LogDataType type = LogDataMain;
+		QString message;
+		Entry *next = nullptr;
+	};
+
+	void runWriter() {
+		while (true) {
+			_wakeup.tryAcquire(1, kFlushTimeout);
+			_wakeup.tryAcquire(_wakeup.available());
+
+			QMutexLocker lock(&_filesMutex);
+			writePending();
+			if (_stopping) {
+				return;
+			}
 		}
-		const auto file = files[type].get();
-		if (!file || !file->isOpen()) {
+	}
+
+	// Must be locked: _filesMutex.
+	void writePending() {
+		auto list = _pending.exchange(nullptr, std::memory_order_acquire);
+		if (!list) {
 			return;
 		}
-		file->write(msg.toUtf8());
-		file->flush();
+
+		// Entries are pushed to the front, restore the order.
+		auto ordered = (Entry*)nullptr;
+		while (list) {
+			const auto next = list->next;
+			list->next = ordered;
+			ordered = list;
+			list = next;
+		}
+
+		bool written[LogDataCount] = { false };
+		while (ordered) {
+			const auto entry = std::unique_ptr<Entry>(ordered);
+			ordered = entry->next;
+
+			const auto type = entry->type;
+			if (type != LogDataMain) {
+				reopenDebug();
+			}
+			const auto file = files[type].get();
+			if (!file || !file->isOpen()) {
+				continue;
+			}
+			file->write(entry->message.toUtf8());
+			written[type] = true;
+		}
+		for (int32 i = 0; i < LogDataCount; ++i) {
+			if (written[i]) {
+				files[i]->flush();
+			}
+		}
 	}
 
+	std::atomic<Entry*> _pending = nullptr;
+	QMutex _filesMutex;
+	QMutex _mainMutex;
+	QSemaphore _wakeup;
+	std::atomic<bool> _stopping = false;
+	std::thread _writer;
+
 private:
 	std::unique_ptr<QFile> files[LogDataCount];
 
 	int32 part = -1;
 
+	// Must be locked: _filesMutex.
 	bool reopen(LogDataType type, int32 dayIndex, const QString &postfix) {
 		if (files[type] && files[type]->isOpen()) {
 			if (type == LogDataMain) {
@@ -246,7 +334,7 @@ QString LogsBeforeSingleInstanceChecked; // LogsInMemory already dumped in LogsD
 void _logsWrite(LogDataType type, const QString &msg) {
 	if (LogsData && (type == LogDataMain || LogsStartIndexChosen < 0)) {
 		if (type == LogDataMain || Logs::DebugEnabled()) {
-			LogsData->write(type, msg);
+			LogsData->write(type, QString(msg));
 		}
 	} else if (LogsInMemory != DeletedLogsInMemory) {
 		if (!LogsInMemory) {
@@ -461,8 +549,6 @@ void finish() {
 	}
 	LogsInMemory = DeletedLogsInMemory;
 
-	_logsMutex(LogDataMain, true);
-
 	CrashReports::FinishCatching();
 }
 
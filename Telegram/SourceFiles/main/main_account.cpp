@@ -8,7 +8,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_account.h"
 
 #include "base/platform/base_platform_info.h"
+#include "base/unixtime.h"
 #include "core/application.h"
+#include "core/core_settings.h"
 #include "core/shortcuts.h"
 #include "storage/storage_account.h"
 #include "storage/storage_domain.h" // Storage::StartResult.
@@ -35,6 +37,94 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Main {
 namespace {
 
+constexpr auto kDormantRefreshTimeout = 5 * 60 * crl::time(1000);
+constexpr auto kDormantUpdatesRefreshDelay = 3 * crl::time(1000);
+
+struct IncomingMessage {
+	PeerId peer = 0;
+	PeerId from = 0;
+	bool mentioned = false;
+
+	// Known only if the updates have the channel itself.
+	std::optional<bool> megagroup;
+};
+
+[[nodiscard]] std::vector<IncomingMessage> CollectIncomingMessages(
+		const MTPUpdates &updates) {
+	auto result = std::vector<IncomingMessage>();
+	const auto add = [&](const MTPUpdate &update) {
+		const auto message = (update.type() == mtpc_updateNewMessage)
+			? &update.c_updateNewMessage().vmessage()
+			: (update.type() == mtpc_updateNewChannelMessage)
+			? &update.c_updateNewChannelMessage().vmessage()
+			: nullptr;
+		if (!message) {
+			return;
+		}
+		message->match([](const MTPDmessageEmpty &) {
+		}, [&](const auto &data) {
+			if (!data.is_out()) {
+				const auto from = data.vfrom_id();
+				result.push_back({
+					.peer = peerFromMTP(data.vpeer_id()),
+					.from = from ? peerFromMTP(*from) : PeerId(0),
+					.mentioned = data.is_mentioned(),
+				});
+			}
+		});
+	};
+	const auto addList = [&](
+			const MTPVector<MTPUpdate> &list,
+			const MTPVector<MTPChat> &chats) {
+		for (const auto &update : list.v) {
+			add(update);
+		}
+		for (const auto &chat : chats.v) {
+			chat.match([&](const MTPDchannel &data) {
+				const auto peer = peerFromChannel(data.vid());
+				for (auto &message : result) {
+					if (message.peer == peer) {
+						message.megagroup = data.is_megagroup();
+					}
+				}
+			}, [](const auto &) {
+			});
+		}
+	};
+	updates.match([&](const MTPDupdateShortMessage &data) {
+		if (!data.is_out()) {
+			const auto peer = peerFromUser(data.vuser_id());
+			result.push_back({
+				.peer = peer,
+				.from = peer,
+				.mentioned = data.is_mentioned(),
+			});
+		}
+	}, [&](const MTPDupdateShortChatMessage &data) {
+		if (!data.is_out()) {
+			result.push_back({
+				.peer = peerFromChat(data.vchat_id()),
+				.from = peerFromUser(data.vfrom_id()),
+				.mentioned = data.is_mentioned(),
+			});
+		}
+	}, [&](const MTPDupdateShort &data) {
+		add(data.vupdate());
+	}, [&](const MTPDupdates &data) {
+		addList(data.vupdates(), data.vchats());
+	}, [&](const MTPDupdatesCombined &data) {
+		addList(data.vupdates(), data.vchats());
+	}, [](const auto &) {
+	});
+	return result;
+}
+
+[[nodiscard]] std::optional<TimeId> MuteUntil(
+		const MTPPeerNotifySettings &settings) {
+	const auto until = settings.c_peerNotifySettings().vmute_until();
+	return until ? std::make_optional(until->v) : std::nullopt;
+}
+
 [[nodiscard]] QString ComposeDataString(const QString &dataName, int index) {
 	auto result = dataName;
 	result.replace('#', QString());
@@ -50,7 +140,8 @@ Account::Account(not_null<Domain*> domain, const QString &dataName, int index)
 : _domain(domain)
 , _local(std::make_unique<Storage::Account>(
 	this,
-	ComposeDataString(dataName, index))) {
+	ComposeDataString(dataName, index)))
+, _dormantRefreshTimer([=] { refreshDormantState(); }) {
 }
 
 Account::~Account() {
@@ -194,6 +285,17 @@ void Account::destroySession(DestroyReason reason) {
 	_storedSessionSettings.reset();
 	_sessionUserId = 0;
 	_sessionUserSerialized = {};
+	if (dormant()) {
+		_dormantLifetime.destroy();
+		_dormantApi.reset();
+		_dormantRefreshTimer.cancel();
+		_dormantRequestId = 0;
+		_dormantNotify = {};
+		_dormantUnreadCount = 0;
+		_dormantUser = {};
+		_dormantState = std::nullopt;
+		_dormant = false;
+	}
 	if (!sessionExists()) {
 		return;
 	}
@@ -206,6 +308,264 @@ void Account::destroySession(DestroyReason reason) {
 	_session = nullptr;
 }
 
+void Account::setDormant(bool dormant) {
+	Expects(!_mtp);
+
+	_dormant = dormant;
+}
+
+bool Account::dormant() const {
+	return _dormant.current();
+}
+
+rpl::producer<bool> Account::dormantChanges() const {
+	return _dormant.changes();
+}
+
+int Account::dormantUnreadCount() const {
+	return _dormantUnreadCount.current();
+}
+
+rpl::producer<int> Account::dormantUnreadCountChanges() const {
+	return _dormantUnreadCount.changes();
+}
+
+bool Account::authorized() const {
+	return sessionExists() || dormant();
+}
+
+UserId Account::authorizedUserId() const {
+	return sessionExists()
+		? session().userId()
+		: dormant()
+		? _sessionUserId
+		: UserId();
+}
+
+QString Account::authorizedPhone() const {
+	return sessionExists()
+		? session().user()->phone()
+		: dormant()
+		? _dormantUser.phone
+		: QString();
+}
+
+QString Account::authorizedName() const {
+	return sessionExists()
+		? session().user()->name
+		: dormant()
+		? (_dormantUser.firstName + ' ' + _dormantUser.lastName).trimmed()
+		: QString();
+}
+
+void Account::startDormant() {
+	Expects(_mtp != nullptr);
+
+	_dormantApi.emplace(_mtp.get());
+
+	QDataStream peekStream(_sessionUserSerialized);
+	_dormantUser = Serialize::peekUser(
+		_sessionUserStreamVersion,
+		peekStream
+	).value_or(Serialize::PeekedUser());
+
+	// Any update means something has changed, the server sends them
+	// to this connection after the first updates.getState request.
+	_mtpUpdates.events(
+	) | rpl::start_with_next([=](const MTPUpdates &updates) {
+		applyDormantNotifySettings(updates);
+		if (Core::App().settings().notifyFromAll()
+			&& dormantNotificationExpected(updates)) {
+			// Notifications need the full session, it will continue
+			// from _dormantState and receive this message in difference.
+			crl::on_main(this, [=] {
+				materializeSession();
+			});
+			return;
+		} else if (!_dormantRefreshTimer.isActive()
+			|| _dormantRefreshTimer.remainingTime()
+				> kDormantUpdatesRefreshDelay) {
+			_dormantRefreshTimer.callOnce(kDormantUpdatesRefreshDelay);
+		}
+	}, _dormantLifetime);
+
+	refreshDormantState();
+	requestDormantNotifySettings();
+}
+
+void Account::requestDormantNotifySettings() {
+	const auto requestDefault = [&](
+			MTPInputNotifyPeer peer,
+			std::optional<TimeId> DormantNotifySettings::*field) {
+		_dormantApi->request(MTPaccount_GetNotifySettings(
+			peer
+		)).done([=](const MTPPeerNotifySettings &result) {
+			_dormantNotify.*field = MuteUntil(result).value_or(0);
+		}).send();
+	};
+	requestDefault(
+		MTP_inputNotifyUsers(),
+		&DormantNotifySettings::usersMuteUntil);
+	requestDefault(
+		MTP_inputNotifyChats(),
+		&DormantNotifySettings::chatsMuteUntil);
+	requestDefault(
+		MTP_inputNotifyBroadcasts(),
+		&DormantNotifySettings::broadcastsMuteUntil);
+
+	_dormantApi->request(MTPaccount_GetNotifyExceptions(
+		MTP_flags(0),
+		MTPInputNotifyPeer()
+	)).done([=](const MTPUpdates &result) {
+		applyDormantNotifySettings(result);
+		_dormantNotify.exceptionsLoaded = true;
+	}).send();
+}
+
+void Account::applyDormantNotifySettings(const MTPUpdates &updates) {
+	const auto apply = [&](const MTPUpdate &update) {
+		if (update.type() == mtpc_updateNotifySettings) {
+			const auto &data = update.c_updateNotifySettings();
+			applyDormantNotifySettings(
+				data.vpeer(),
+				data.vnotify_settings());
+		}
+	};
+	updates.match([&](const MTPDupdateShort &data) {
+		apply(data.vupdate());
+	}, [&](const MTPDupdates &data) {
+		for (const auto &update : data.vupdates().v) {
+			apply(update);
+		}
+	}, [&](const MTPDupdatesCombined &data) {
+		for (const auto &update : data.vupdates().v) {
+			apply(update);
+		}
+	}, [](const auto &) {
+	});
+}
+
+void Account::applyDormantNotifySettings(
+		const MTPNotifyPeer &notifyPeer,
+		const MTPPeerNotifySettings &settings) {
+	const auto until = MuteUntil(settings);
+	notifyPeer.match([&](const MTPDnotifyPeer &data) {
+		const auto peer = peerFromMTP(data.vpeer());
+		if (until) {
+			_dormantNotify.muteUntil[peer] = *until;
+		} else {
+			_dormantNotify.muteUntil.remove(peer);
+		}
+	}, [&](const MTPDnotifyUsers &) {
+		_dormantNotify.usersMuteUntil = until.value_or(0);
+	}, [&](const MTPDnotifyChats &) {
+		_dormantNotify.chatsMuteUntil = until.value_or(0);
+	}, [&](const MTPDnotifyBroadcasts &) {
+		_dormantNotify.broadcastsMuteUntil = until.value_or(0);
+	});
+}
+
+std::optional<bool> Account::dormantNotifyMuted(
+		PeerId peer,
+		std::optional<bool> megagroup) const {
+	const auto now = base::unixtime::now();
+	const auto &settings = _dormantNotify;
+	const auto i = settings.muteUntil.find(peer);
+	if (i != end(settings.muteUntil)) {
+		return (i->second > now);
+	} else if (!settings.exceptionsLoaded) {
+		return std::nullopt;
+	}
+	const auto muted = [&](const std::optional<TimeId> &until) {
+		return until ? std::make_optional(*until > now) : std::nullopt;
+	};
+	if (peerIsUser(peer)) {
+		return muted(settings.usersMuteUntil);
+	} else if (peerIsChat(peer) || (megagroup && *megagroup)) {
+		return muted(settings.chatsMuteUntil);
+	} else if (megagroup) {
+		return muted(settings.broadcastsMuteUntil);
+	}
+
+	// We don't know if the channel is a group, check both.
+	const auto chats = muted(settings.chatsMuteUntil);
+	const auto broadcasts = muted(settings.broadcastsMuteUntil);
+	return (chats && broadcasts)
+		? std::make_optional(*chats && *broadcasts)
+		: std::nullopt;
+}
+
+bool Account::dormantNotificationExpected(const MTPUpdates &updates) const {
+	const auto &settings = Core::App().settings();
+	if (!settings.desktopNotify()
+		&& !settings.soundNotify()
+		&& !settings.flashBounceNotify()) {
+		return false;
+	}
+	// Same as Window::Notifications::System::skipNotification(): a muted
+	// chat still notifies about a mention by a not muted user.
+	const auto expected = [&](const IncomingMessage &message) {
+		const auto muted = dormantNotifyMuted(
+			message.peer,
+			message.megagroup);
+		if (!muted.value_or(false)) {
+			return true;
+		}
+		return message.mentioned
+			&& peerIsUser(message.from)
+			&& !dormantNotifyMuted(message.from, {}).value_or(false);
+	};
+	return ranges::any_of(CollectIncomingMessages(updates), expected);
+}
+
+void Account::refreshDormantState() {
+	if (!_dormantApi || _dormantRequestId) {
+		return;
+	}
+	_dormantRequestId = _dormantApi->request(MTPupdates_GetState(
+	)).done([=](const MTPupdates_State &result) {
+		_dormantRequestId = 0;
+		_dormantState = result;
+		_dormantUnreadCount = result.c_updates_state().vunread_count().v;
+		_dormantRefreshTimer.callOnce(kDormantRefreshTimeout);
+	}).fail([=](const MTP::Error &error) {
+		_dormantRequestId = 0;
+		_dormantRefreshTimer.callOnce(kDormantRefreshTimeout);
+	}).send();
+}
+
+std::optional<MTPupdates_State> Account::takeDormantState() {
+	return base::take(_dormantState);
+}
+
+void Account::materializeSession() {
+	if (!dormant()) {
+		return;
+	}
+	Expects(_mtp != nullptr);
+
+	_dormantLifetime.destroy();
+	_dormantApi.reset();
+	_dormantRefreshTimer.cancel();
+	_dormantRequestId = 0;
+	_dormantNotify = {};
+
+	createSession(
+		_sessionUserId,
+		base::take(_sessionUserSerialized),
+		base::take(_sessionUserStreamVersion),
+		(_storedSessionSettings
+			? std::move(_storedSessionSettings)
+			: std::make_unique<SessionSettings>()));
+	_storedSessionSettings = nullptr;
+
+	// Skip all pending self updates so that we won't local().writeSelf.
+	session().changes().sendNotifications();
+
+	_dormantUnreadCount = 0;
+	_dormant = false;
+}
+
 bool Account::sessionExists() const {
 	return (_sessionValue.current() != nullptr);
 }
@@ -285,6 +645,8 @@ QByteArray Account::serializeMtpAuthorization() const {
 
 			const auto currentUserId = sessionExists()
 				? session().userId()
+				: dormant()
+				? _sessionUserId
 				: 0;
 			stream << qint32(currentUserId) << qint32(mainDcId);
 			writeKeys(stream, keys);
@@ -407,7 +769,8 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 	const auto writingConfig = _lifetime.make_state<bool>(false);
 	rpl::merge(
 		_mtp->config().updates(),
-		_mtp->dcOptions().changed() | rpl::to_empty
+		_mtp->dcOptions().changed() | rpl::to_empty,
+		_mtp->dcOptions().connectedChanged()
 	) | rpl::filter([=] {
 		return !*writingConfig;
 	}) | rpl::start_with_next([=] {
@@ -426,6 +789,8 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 	_mtp->setGlobalFailHandler([=](const MTP::Error &, const MTP::Response &) {
 		if (const auto session = maybeSession()) {
 			crl::on_main(session, [=] { logOut(); });
+		} else if (dormant()) {
+			crl::on_main(this, [=] { logOut(); });
 		}
 	});
 	_mtp->setStateChangedHandler([=](MTP::ShiftedDcId dc, int32 state) {
@@ -445,20 +810,27 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 		destroyMtpKeys(base::take(_mtpKeysToDestroy));
 	}
 
-	if (_sessionUserId) {
-		createSession(
-			_sessionUserId,
-			base::take(_sessionUserSerialized),
-			base::take(_sessionUserStreamVersion),
-			(_storedSessionSettings
-				? std::move(_storedSessionSettings)
-				: std::make_unique<SessionSettings>()));
+	if (!_sessionUserId) {
+		_dormant = false;
 	}
-	_storedSessionSettings = nullptr;
+	if (dormant()) {
+		startDormant();
+	} else {
+		if (_sessionUserId) {
+			createSession(
+				_sessionUserId,
+				base::take(_sessionUserSerialized),
+				base::take(_sessionUserStreamVersion),
+				(_storedSessionSettings
+					? std::move(_storedSessionSettings)
+					: std::make_unique<SessionSettings>()));
+		}
+		_storedSessionSettings = nullptr;
 
-	if (const auto session = maybeSession()) {
-		// Skip all pending self updates so that we won't local().writeSelf.
-		session->changes().sendNotifications();
+		if (const auto session = maybeSession()) {
+			// Skip all pending self updates so that we won't local().writeSelf.
+			session->changes().sendNotifications();
+		}
 	}
 
 	_mtpValue = _mtp.get();
@@ -502,7 +874,7 @@ bool Account::loggingOut() const {
 }
 
 void Account::forcedLogOut() {
-	if (sessionExists()) {
+	if (authorized()) {
 		resetAuthorizationKeys();
 		loggedOut();
 	}
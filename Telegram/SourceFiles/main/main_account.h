@@ -9,7 +9,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "mtproto/mtproto_auth_key.h"
 #include "mtproto/mtp_instance.h"
+#include "mtproto/sender.h"
+#include "storage/serialize_peer.h"
 #include "base/weak_ptr.h"
+#include "base/timer.h"
 
 namespace Storage {
 class Account;
@@ -72,6 +75,27 @@ public:
 		return *_local;
 	}
 
+	// Dormant accounts keep only the MTP instance and the stored session
+	// data, polling the unread counter. The Session is created lazily.
+	void setDormant(bool dormant);
+	[[nodiscard]] bool dormant() const;
+	[[nodiscard]] rpl::producer<bool> dormantChanges() const;
+	[[nodiscard]] int dormantUnreadCount() const;
+	[[nodiscard]] rpl::producer<int> dormantUnreadCountChanges() const;
+	void materializeSession();
+
+	// The last updates state a dormant account has received, so that
+	// the new session could continue from it with a difference.
+	[[nodiscard]] std::optional<MTPupdates_State> takeDormantState();
+
+	// Has a session or a stored one for a dormant account.
+	[[nodiscard]] bool authorized() const;
+
+	// Self user of the session or the stored one of a dormant account.
+	[[nodiscard]] UserId authorizedUserId() const;
+	[[nodiscard]] QString authorizedPhone() const;
+	[[nodiscard]] QString authorizedName() const;
+
 	[[nodiscard]] bool sessionExists() const;
 	[[nodiscard]] Session &session() const;
 	[[nodiscard]] Session *maybeSession() const;
@@ -122,6 +146,28 @@ private:
 		std::unique_ptr<SessionSettings> settings);
 	void watchProxyChanges();
 	void watchSessionChanges();
+	// Mute settings of a dormant account, the ones from the server
+	// exceptions list by peer and the default ones by notify scope.
+	struct DormantNotifySettings {
+		base::flat_map<PeerId, TimeId> muteUntil;
+		std::optional<TimeId> usersMuteUntil;
+		std::optional<TimeId> chatsMuteUntil;
+		std::optional<TimeId> broadcastsMuteUntil;
+		bool exceptionsLoaded = false;
+	};
+
+	void startDormant();
+	void refreshDormantState();
+	void requestDormantNotifySettings();
+	void applyDormantNotifySettings(const MTPUpdates &updates);
+	void applyDormantNotifySettings(
+		const MTPNotifyPeer &notifyPeer,
+		const MTPPeerNotifySettings &settings);
+	[[nodiscard]] std::optional<bool> dormantNotifyMuted(
+		PeerId peer,
+		std::optional<bool> megagroup) const;
+	[[nodiscard]] bool dormantNotificationExpected(
+		const MTPUpdates &updates) const;
 	bool checkForUpdates(const MTP::Response &message);
 	bool checkForNewSession(const MTP::Response &message);
 
@@ -153,6 +199,16 @@ private:
 	MTP::AuthKeysList _mtpKeysToDestroy;
 	bool _loggingOut = false;
 
+	rpl::variable<bool> _dormant = false;
+	rpl::variable<int> _dormantUnreadCount = 0;
+	Serialize::PeekedUser _dormantUser;
+	std::optional<MTPupdates_State> _dormantState;
+	std::optional<MTP::Sender> _dormantApi;
+	base::Timer _dormantRefreshTimer;
+	mtpRequestId _dormantRequestId = 0;
+	DormantNotifySettings _dormantNotify;
+	rpl::lifetime _dormantLifetime;
+
 	rpl::lifetime _lifetime;
 
 };
@@ -147,7 +147,7 @@ rpl::producer<> Domain::accountsChanges() const {
 Account *Domain::maybeLastOrSomeAuthedAccount() {
 	auto result = (Account*)nullptr;
 	for (const auto &[index, account] : _accounts) {
-		if (!account->sessionExists()) {
+		if (!account->authorized()) {
 			continue;
 		} else if (index == _lastActiveIndex) {
 			return account.get();
@@ -218,6 +218,10 @@ void Domain::updateUnreadBadge() {
 			if (!data->unreadBadgeMuted()) {
 				_unreadBadgeMuted = false;
 			}
+		} else if (const auto count = account->dormantUnreadCount()) {
+			// Dormant accounts know only the total unread messages count.
+			_unreadBadge += count;
+			_unreadBadgeMuted = false;
 		}
 	}
 	_unreadBadgeChanges.fire({});
@@ -287,7 +291,7 @@ void Domain::addActivated(MTP::Environment environment) {
 		activate(add(environment));
 	} else {
 		for (auto &[index, account] : accounts()) {
-			if (!account->sessionExists()
+			if (!account->authorized()
 				&& account->mtp().environment() == environment) {
 				activate(account.get());
 				break;
@@ -307,10 +311,21 @@ void Domain::watchSession(not_null<Account*> account) {
 		}, session->lifetime());
 	}, account->lifetime());
 
-	account->sessionChanges(
-	) | rpl::filter([=](Session *session) {
-		return !session;
-	}) | rpl::start_with_next([=] {
+	account->dormantUnreadCountChanges(
+	) | rpl::start_with_next([=] {
+		scheduleUpdateUnreadBadge();
+	}, account->lifetime());
+
+	rpl::merge(
+		account->sessionChanges(
+		) | rpl::filter([=](Session *session) {
+			return !session;
+		}) | rpl::to_empty,
+		account->dormantChanges(
+		) | rpl::filter([=](bool dormant) {
+			return !dormant && !account->sessionExists();
+		}) | rpl::to_empty
+	) | rpl::start_with_next([=] {
 		scheduleUpdateUnreadBadge();
 		if (account == _active.current()) {
 			activateAuthedAccount();
@@ -328,7 +343,7 @@ void Domain::activateAuthedAccount() {
 		return;
 	}
 	for (auto i = _accounts.begin(); i != _accounts.end(); ++i) {
-		if (i->account->sessionExists()) {
+		if (i->account->authorized()) {
 			activate(i->account.get());
 			return;
 		}
@@ -356,7 +371,7 @@ void Domain::removeRedundantAccounts() {
 	activateAuthedAccount();
 	for (auto i = _accounts.begin(); i != _accounts.end();) {
 		if (i->account.get() == _active.current()
-			|| i->account->sessionExists()) {
+			|| i->account->authorized()) {
 			++i;
 			continue;
 		}
@@ -409,6 +424,7 @@ void Domain::activate(not_null<Main::Account*> account) {
 		wasAuthed = _active.current()->sessionExists();
 	}
 	_accountToActivate = i->index;
+	account->materializeSession();
 	_active = account.get();
 	_active.current()->sessionValue(
 	) | rpl::start_to_stream(_activeSessions, _activeLifetime);
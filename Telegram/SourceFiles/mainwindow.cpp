@@ -770,7 +770,7 @@ void MainWindow::closeEvent(QCloseEvent *e) {
 				return false;
 			}
 			for (const auto &[_, account] : Core::App().domain().accounts()) {
-				if (account->sessionExists()) {
+				if (account->authorized()) {
 					return true;
 				}
 			}
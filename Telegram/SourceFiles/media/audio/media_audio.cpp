@@ -34,9 +34,11 @@ namespace {
 constexpr auto kSuppressRatioAll = 0.2;
 constexpr auto kSuppressRatioSong = 0.05;
 constexpr auto kWaveformCounterBufferSize = 256 * 1024;
+constexpr auto kWaveformPartialStep = 10;
 constexpr auto kEffectDestructionDelay = crl::time(1000);
 
 QMutex AudioMutex;
+std::atomic<bool> DevicesPrepared = false;
 ALCdevice *AudioDevice = nullptr;
 ALCcontext *AudioContext = nullptr;
 
@@ -189,19 +191,27 @@ void ClosePlaybackDevice(not_null<Instance*> instance) {
 
 } // namespace
 
-  // Thread: Main.
-void Start(not_null<Instance*> instance) {
-	Assert(AudioDevice == nullptr);
-
-	qRegisterMetaType<AudioMsgId>();
-	qRegisterMetaType<VoiceWaveform>();
-
+// Thread: Any.
+void PrepareDevices() {
+	if (DevicesPrepared.exchange(true)) {
+		return;
+	}
 	auto loglevel = getenv("ALSOFT_LOGLEVEL");
 	LOG(("OpenAL Logging Level: %1").arg(loglevel ? loglevel : "(not set)"));
 
 	OpenAL::LoadEFXExtension();
 	EnumeratePlaybackDevices();
 	EnumerateCaptureDevices();
+}
+
+// Thread: Main.
+void Start(not_null<Instance*> instance) {
+	Assert(AudioDevice == nullptr);
+
+	qRegisterMetaType<AudioMsgId>();
+	qRegisterMetaType<VoiceWaveform>();
+
+	PrepareDevices();
 
 	MixerInstance = new Player::Mixer(instance);
 
@@ -1720,7 +1730,12 @@ Ui::PreparedFileInformation::Song PrepareForSending(const QString &fname, const
 
 class FFMpegWaveformCounter : public FFMpegLoader {
 public:
-	FFMpegWaveformCounter(const Core::FileLocation &file, const QByteArray &data) : FFMpegLoader(file, data, bytes::vector()) {
+	FFMpegWaveformCounter(
+		const Core::FileLocation &file,
+		const QByteArray &data,
+		Fn<void(VoiceWaveform&&)> partial)
+	: FFMpegLoader(file, data, bytes::vector())
+	, _partial(std::move(partial)) {
 	}
 
 	bool open(crl::time positionMs) override {
@@ -1742,6 +1757,7 @@ public:
 
 		auto fmt = format();
 		auto peak = uint16(0);
+		auto reported = 0;
 		auto callback = [&](uint16 sample) {
 			accumulate_max(peak, sample);
 			sumbytes += Media::Player::kWaveformSamplesCount;
@@ -1770,6 +1786,13 @@ public:
 				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
 			}
 			processed += sampleSize() * samples;
+
+			if (_partial
+				&& processed < countbytes
+				&& peaks.size() >= reported + kWaveformPartialStep) {
+				reported = peaks.size();
+				_partial(Normalize(peaks, Media::Player::kWaveformSamplesCount));
+			}
 		}
 		if (sumbytes > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
 			peaks.push_back(peak);
@@ -1779,14 +1802,7 @@ public:
 			return false;
 		}
 
-		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
-		peak = qMax(int32(sum * 1.8 / peaks.size()), 2500);
-
-		result.resize(peaks.size());
-		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
-			result[i] = char(qMin(31U, uint32(qMin(peaks.at(i), peak)) * 31 / peak));
-		}
-
+		result = Normalize(peaks, peaks.size());
 		return true;
 	}
 
@@ -1798,6 +1814,23 @@ public:
 	}
 
 private:
+	// Values not counted yet (up to the 'size') are filled with zeros.
+	[[nodiscard]] static VoiceWaveform Normalize(
+			const QVector<uint16> &peaks,
+			int size) {
+		Expects(!peaks.isEmpty());
+
+		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
+		const auto peak = uint16(qMax(int32(sum * 1.8 / peaks.size()), 2500));
+
+		auto result = VoiceWaveform(std::max(size, int(peaks.size())), 0);
+		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
+			result[i] = char(qMin(31U, uint32(qMin(peaks.at(i), peak)) * 31 / peak));
+		}
+		return result;
+	}
+
+	Fn<void(VoiceWaveform&&)> _partial;
 	VoiceWaveform result;
 
 };
@@ -1806,8 +1839,9 @@ private:
 
 VoiceWaveform audioCountWaveform(
 		const Core::FileLocation &file,
-		const QByteArray &data) {
-	Media::FFMpegWaveformCounter counter(file, data);
+		const QByteArray &data,
+		Fn<void(VoiceWaveform&&)> partial) {
+	Media::FFMpegWaveformCounter counter(file, data, std::move(partial));
 	const auto positionMs = crl::time(0);
 	if (counter.open(positionMs)) {
 		return counter.waveform();
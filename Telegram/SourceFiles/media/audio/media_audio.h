@@ -31,6 +31,9 @@ namespace Audio {
 
 class Instance;
 
+// Thread: Any. Probes OpenAL backends, may be called before Start().
+void PrepareDevices();
+
 // Thread: Main.
 void Start(not_null<Instance*> instance);
 void Finish(not_null<Instance*> instance);
@@ -391,7 +394,12 @@ bool audioCheckError();
 } // namespace Player
 } // namespace Media
 
-VoiceWaveform audioCountWaveform(const Core::FileLocation &file, const QByteArray &data);
+// Thread: Any. The 'partial' callback is called from the same thread
+// with the waveform counted so far, padded with zeros to the full size.
+VoiceWaveform audioCountWaveform(
+	const Core::FileLocation &file,
+	const QByteArray &data,
+	Fn<void(VoiceWaveform&&)> partial = nullptr);
 
 namespace Media {
 namespace Audio {
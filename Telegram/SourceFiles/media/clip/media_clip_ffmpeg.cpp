@@ -204,6 +204,12 @@ bool FFMpegReaderImplementation::renderFrame(QImage &to, bool &hasAlpha, const Q
 			return false;
 		}
 	}
+	if (_profileSize != size) {
+		_profileSize = size;
+		FFmpeg::ApplyDecoderProfile(
+			_codecContext,
+			FFmpeg::ChooseDecoderProfile(QSize(_width, _height), size));
+	}
 	QSize toSize(size.isEmpty() ? QSize(_width, _height) : size);
 	if (!size.isEmpty() && rotationSwapWidthHeight()) {
 		toSize.transpose();
@@ -313,6 +319,7 @@ bool FFMpegReaderImplementation::start(Mode mode, crl::time &positionMs) {
 		return false;
 	}
 	_codecContext->pkt_timebase = _fmtContext->streams[_streamId]->time_base;
+	FFmpeg::ApplyDecoderThreads(_codecContext);
 	av_opt_set_int(_codecContext, "refcounted_frames", 1, 0);
 
 	const auto codec = avcodec_find_decoder(_codecContext->codec_id);
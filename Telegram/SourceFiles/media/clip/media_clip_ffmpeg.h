@@ -99,6 +99,7 @@ private:
 	int _height = 0;
 	SwsContext *_swsContext = nullptr;
 	QSize _swsSize;
+	QSize _profileSize;
 
 	crl::time _frameMs = 0;
 	int _nextFrameDelay = 0;
@@ -10,7 +10,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/clip/media_clip_ffmpeg.h"
 #include "media/clip/media_clip_check_streaming.h"
 #include "core/file_location.h"
-#include "base/openssl_help.h"
 #include "base/invoke_queued.h"
 #include "logs.h"
 
@@ -32,9 +31,23 @@ namespace Clip {
 namespace {
 
 constexpr auto kClipThreadsCount = 8;
-constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
 
+// Reader load is measured in microseconds of decoding per second.
+// Before the first frames are decoded assume 2ms per frame at 30 fps.
+constexpr auto kInitialReaderLoad = 30 * 2000;
+
+// Start a new thread only if all of them are loaded more than that.
+constexpr auto kThreadLoadLimit = 250 * 1000;
+
+// Readers are processed in one pass while it takes less than that,
+// frames of the others are delayed, slowing those animations down.
+constexpr auto kProcessBudget = crl::time(12);
+constexpr auto kOverflowDelay = crl::time(16);
+
+// Frames shown less often than that don't count for the load.
+constexpr auto kMinLoadFrameDelay = crl::time(10);
+
 QVector<QThread*> threads;
 QVector<Manager*> managers;
 
@@ -109,21 +122,25 @@ Reader::Reader(const QByteArray &data, Callback &&callback)
 }
 
 void Reader::init(const Core::FileLocation &location, const QByteArray &data) {
-	if (threads.size() < kClipThreadsCount) {
+	static const auto maxThreads = std::clamp(
+		QThread::idealThreadCount() - 1,
+		1,
+		kClipThreadsCount);
+
+	auto loadLevel = std::numeric_limits<int>::max();
+	for (auto i = 0, l = int(threads.size()); i != l; ++i) {
+		const auto level = managers.at(i)->loadLevel();
+		if (level < loadLevel) {
+			_threadIndex = i;
+			loadLevel = level;
+		}
+	}
+	if (threads.size() < maxThreads
+		&& (threads.isEmpty() || loadLevel > kThreadLoadLimit)) {
 		_threadIndex = threads.size();
 		threads.push_back(new QThread());
 		managers.push_back(new Manager(threads.back()));
 		threads.back()->start();
-	} else {
-		_threadIndex = int32(openssl::RandomValue<uint32>() % threads.size());
-		int32 loadLevel = 0x7FFFFFFF;
-		for (int32 i = 0, l = threads.size(); i < l; ++i) {
-			int32 level = managers.at(i)->loadLevel();
-			if (level < loadLevel) {
-				_threadIndex = i;
-				loadLevel = level;
-			}
-		}
 	}
 	managers.at(_threadIndex)->append(this, location, data);
 }
@@ -427,6 +444,12 @@ public:
 	}
 
 	ProcessResult finishProcess(crl::time ms) {
+		const auto started = crl::profile();
+		const auto guard = gsl::finally([&] {
+			const auto cost = crl::profile() - started;
+			_frameCost = _frameCost ? ((_frameCost * 3 + cost) / 4) : cost;
+		});
+
 		auto frameMs = _seekPositionMs + ms - _animationStarted;
 		auto readResult = _implementation->readFramesTill(frameMs, ms);
 		if (readResult == internal::ReaderImplementation::ReadResult::EndOfFile) {
@@ -493,13 +516,16 @@ public:
 	void resumeVideo(crl::time ms) {
 		if (!_videoPausedAtMs) return; // Not paused.
 
-		auto delta = ms - _videoPausedAtMs;
-		_animationStarted += delta;
-		_nextFrameWhen += delta;
+		delayAnimation(ms - _videoPausedAtMs);
 
 		_videoPausedAtMs = 0;
 	}
 
+	void delayAnimation(crl::time delay) {
+		_animationStarted += delay;
+		_nextFrameWhen += delay;
+	}
+
 	ProcessResult error() {
 		stop();
 		_state = State::Error;
@@ -562,6 +588,10 @@ private:
 	bool _started = false;
 	crl::time _videoPausedAtMs = 0;
 
+	crl::profile_time _frameCost = 0;
+	crl::time _lastFrameAt = 0;
+	int _load = kInitialReaderLoad;
+
 	friend class Manager;
 
 };
@@ -578,7 +608,7 @@ Manager::Manager(QThread *thread) {
 
 void Manager::append(Reader *reader, const Core::FileLocation &location, const QByteArray &data) {
 	reader->_private = new ReaderPrivate(reader, location, data);
-	_loadLevel.fetchAndAddRelaxed(kAverageGifSize);
+	_loadLevel.fetchAndAddRelaxed(reader->_private->_load);
 	update(reader);
 }
 
@@ -652,7 +682,6 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 	}
 
 	if (result == ProcessResult::Started) {
-		_loadLevel.fetchAndAddRelaxed(reader->_width * reader->_height - kAverageGifSize);
 		it.key()->_durationMs = reader->_durationMs;
 	}
 	// See if we need to pause GIF because it is not displayed right now.
@@ -693,7 +722,7 @@ bool Manager::handleProcessResult(ReaderPrivate *reader, ProcessResult result, c
 
 Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessResult result, crl::time ms) {
 	if (!handleProcessResult(reader, result, ms)) {
-		_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : kAverageGifSize));
+		_loadLevel.fetchAndAddRelaxed(-reader->_load);
 		delete reader;
 		return ResultHandleRemove;
 	}
@@ -762,39 +791,62 @@ void Manager::process() {
 		checkAllReaders = (_readers.size() > _readerPointers.size());
 	}
 
+	auto due = std::vector<DueReader>();
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
 		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
-			if (state == ResultHandleRemove) {
-				i = _readers.erase(i);
-				continue;
-			} else if (state == ResultHandleStop) {
-				_processingInThread = nullptr;
-				return;
-			}
-			ms = crl::now();
-			if (reader->_videoPausedAtMs) {
-				i.value() = ms + 86400 * 1000ULL;
-			} else if (reader->_nextFrameWhen && reader->_started) {
-				i.value() = reader->_nextFrameWhen;
-			} else {
-				i.value() = (ms + 86400 * 1000ULL);
-			}
+			due.push_back({ reader, i.value() });
 		} else if (checkAllReaders) {
 			QMutexLocker lock(&_readerPointersMutex);
 			auto it = constUnsafeFindReaderPointer(reader);
 			if (it == _readerPointers.cend()) {
-				_loadLevel.fetchAndAddRelaxed(-1 * (reader->_width > 0 ? reader->_width * reader->_height : kAverageGifSize));
+				_loadLevel.fetchAndAddRelaxed(-reader->_load);
 				delete reader;
 				i = _readers.erase(i);
 				continue;
 			}
 		}
-		if (!reader->_autoPausedGif && i.value() < minms) {
+		++i;
+	}
+	sortByPriority(due);
+
+	const auto budgetTill = ms + kProcessBudget;
+	for (const auto &entry : due) {
+		const auto reader = entry.reader;
+		const auto i = _readers.find(reader);
+		Assert(i != _readers.end());
+
+		if (ms >= budgetTill && reader->_started && reader->_nextFrameWhen) {
+			// Out of budget, show the next frame a bit later.
+			reader->delayAnimation(
+				std::max(ms - reader->_nextFrameWhen, crl::time(0))
+				+ kOverflowDelay);
+			i.value() = reader->_nextFrameWhen;
+			continue;
+		}
+		const auto result = reader->process(ms);
+		ResultHandleState state = handleResult(reader, result, ms);
+		if (state == ResultHandleRemove) {
+			_readers.erase(i);
+			continue;
+		} else if (state == ResultHandleStop) {
+			_processingInThread = nullptr;
+			return;
+		}
+		ms = crl::now();
+		updateLoad(reader, result, ms);
+		if (reader->_videoPausedAtMs) {
+			i.value() = ms + 86400 * 1000ULL;
+		} else if (reader->_nextFrameWhen && reader->_started) {
+			i.value() = reader->_nextFrameWhen;
+		} else {
+			i.value() = (ms + 86400 * 1000ULL);
+		}
+	}
+	for (auto i = _readers.cbegin(), e = _readers.cend(); i != e; ++i) {
+		if (!i.key()->_autoPausedGif && i.value() < minms) {
 			minms = i.value();
 		}
-		++i;
 	}
 
 	ms = crl::now();
@@ -808,6 +860,48 @@ void Manager::process() {
 	_processingInThread = nullptr;
 }
 
+void Manager::sortByPriority(std::vector<DueReader> &due) const {
+	if (due.size() < 2) {
+		return;
+	}
+	{
+		QMutexLocker lock(&_readerPointersMutex);
+		for (auto &entry : due) {
+			const auto it = constUnsafeFindReaderPointer(entry.reader);
+			if (it != _readerPointers.cend()) {
+				const auto frame = it.key()->frameToShow();
+				entry.shown = frame && (frame->displayed.loadAcquire() > 0);
+			}
+		}
+	}
+
+	// Clips that are shown on the screen go first, late ones first.
+	ranges::sort(due, [](const DueReader &a, const DueReader &b) {
+		return (a.shown != b.shown) ? a.shown : (a.when < b.when);
+	});
+}
+
+void Manager::updateLoad(
+		not_null<ReaderPrivate*> reader,
+		ProcessResult result,
+		crl::time ms) {
+	auto load = reader->_load;
+	if (reader->_autoPausedGif || reader->_videoPausedAtMs) {
+		load = 0;
+		reader->_lastFrameAt = 0;
+	} else if (result == ProcessResult::Repaint) {
+		if (const auto last = base::take(reader->_lastFrameAt)) {
+			const auto delay = std::max(ms - last, kMinLoadFrameDelay);
+			load = int(reader->_frameCost * 1000 / delay);
+		}
+		reader->_lastFrameAt = ms;
+	} else {
+		return;
+	}
+	_loadLevel.fetchAndAddRelaxed(load - reader->_load);
+	reader->_load = load;
+}
+
 void Manager::finish() {
 	_timer.stop();
 	clear();
@@ -257,6 +257,17 @@ private:
 	};
 	ResultHandleState handleResult(ReaderPrivate *reader, ProcessResult result, crl::time ms);
 
+	struct DueReader {
+		ReaderPrivate *reader = nullptr;
+		crl::time when = 0;
+		bool shown = false;
+	};
+	void sortByPriority(std::vector<DueReader> &due) const;
+	void updateLoad(
+		not_null<ReaderPrivate*> reader,
+		ProcessResult result,
+		crl::time ms);
+
 	using Readers = QMap<ReaderPrivate*, crl::time>;
 	Readers _readers;
 
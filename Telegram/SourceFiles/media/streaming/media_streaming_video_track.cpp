@@ -78,6 +78,7 @@ private:
 	[[nodiscard]] FrameResult readFrame(not_null<Frame*> frame);
 	void fillRequests(not_null<Frame*> frame) const;
 	[[nodiscard]] QSize chooseOriginalResize() const;
+	void updateDecoderProfile();
 	void presentFrameIfNeeded();
 	void callReady();
 	[[nodiscard]] bool loopAround();
@@ -475,10 +476,19 @@ void VideoTrackObject::updateFrameRequest(
 		const Instance *instance,
 		const FrameRequest &request) {
 	_requests.emplace(instance, request);
+	updateDecoderProfile();
 }
 
 void VideoTrackObject::removeFrameRequest(const Instance *instance) {
 	_requests.remove(instance);
+	updateDecoderProfile();
+}
+
+void VideoTrackObject::updateDecoderProfile() {
+	const auto codec = _stream.codec.get();
+	FFmpeg::ApplyDecoderProfile(codec, FFmpeg::ChooseDecoderProfile(
+		QSize(codec->width, codec->height),
+		chooseOriginalResize()));
 }
 
 bool VideoTrackObject::tryReadFirstFrame(FFmpeg::Packet &&packet) {
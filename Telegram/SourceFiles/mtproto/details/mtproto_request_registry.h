@@ -0,0 +1,97 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/flat_map.h"
+
+#include <QtCore/QMutex>
+#include <array>
+#include <optional>
+
+namespace MTP::details {
+
+// Request ids are sequential, so sharding by the low bits spreads the
+// requests evenly and session threads seldom wait for each other.
+inline constexpr auto kRequestRegistryShards = 16;
+
+// Thread-safe map from request id to some value, split in shards
+// with a separate lock for each of them.
+template <typename Value>
+class RequestRegistry final {
+public:
+	void set(mtpRequestId requestId, Value value) {
+		auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		shard.map[requestId] = std::move(value);
+	}
+
+	[[nodiscard]] std::optional<Value> find(mtpRequestId requestId) const {
+		const auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		return i->second;
+	}
+
+	[[nodiscard]] bool contains(mtpRequestId requestId) const {
+		const auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		return shard.map.contains(requestId);
+	}
+
+	std::optional<Value> take(mtpRequestId requestId) {
+		auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		auto result = std::make_optional(std::move(i->second));
+		shard.map.erase(i);
+		return result;
+	}
+
+	void remove(mtpRequestId requestId) {
+		auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		shard.map.remove(requestId);
+	}
+
+	// Calls method(Value&) for an existing value under the shard lock.
+	template <typename Method>
+	std::optional<Value> update(mtpRequestId requestId, Method &&method) {
+		auto &shard = shardFor(requestId);
+		QMutexLocker lock(&shard.mutex);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		method(i->second);
+		return i->second;
+	}
+
+private:
+	struct Shard {
+		mutable QMutex mutex;
+		base::flat_map<mtpRequestId, Value> map;
+	};
+
+	[[nodiscard]] Shard &shardFor(mtpRequestId requestId) {
+		return _shards[uint32(requestId) % kRequestRegistryShards];
+	}
+	[[nodiscard]] const Shard &shardFor(mtpRequestId requestId) const {
+		return _shards[uint32(requestId) % kRequestRegistryShards];
+	}
+
+	std::array<Shard, kRequestRegistryShards> _shards;
+
+};
+
+} // namespace MTP::details
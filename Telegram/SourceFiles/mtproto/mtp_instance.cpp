@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/mtp_instance.h"
 
 #include "mtproto/details/mtproto_dcenter.h"
+#include "mtproto/details/mtproto_request_registry.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
@@ -250,17 +251,13 @@ private:
 	rpl::event_stream<> _allKeysDestroyed;
 
 	// holds dcWithShift for request to this dc or -dc for request to main dc
-	std::map<mtpRequestId, ShiftedDcId> _requestsByDc;
-	mutable QMutex _requestByDcLock;
+	RequestRegistry<ShiftedDcId> _requestsByDc;
 
 	// holds target dcWithShift for auth export request
 	std::map<mtpRequestId, ShiftedDcId> _authExportRequests;
 
-	std::map<mtpRequestId, ResponseHandler> _parserMap;
-	mutable QMutex _parserMapLock;
-
-	std::map<mtpRequestId, SerializedRequest> _requestMap;
-	QReadWriteLock _requestMapLock;
+	RequestRegistry<ResponseHandler> _parserMap;
+	RequestRegistry<SerializedRequest> _requestMap;
 
 	std::deque<std::pair<mtpRequestId, crl::time>> _delayedRequests;
 
@@ -597,13 +594,8 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: Cancel request %1.").arg(requestId));
 	const auto shiftedDcId = queryRequestByDc(requestId);
 	auto msgId = mtpMsgId(0);
-	{
-		QWriteLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.end()) {
-			msgId = *(mtpMsgId*)(it->second->constData() + 4);
-			_requestMap.erase(it);
-		}
+	if (const auto request = _requestMap.take(requestId)) {
+		msgId = *(mtpMsgId*)((*request)->constData() + 4);
 	}
 	unregisterRequest(requestId);
 	if (shiftedDcId) {
@@ -611,8 +603,7 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 		session->cancel(requestId, msgId);
 	}
 
-	QMutexLocker locker(&_parserMapLock);
-	_parserMap.erase(requestId);
+	_parserMap.remove(requestId);
 }
 
 // result < 0 means waiting for such count of ms.
@@ -889,28 +880,19 @@ bool Instance::Private::configLoadFail(const Error &error) {
 
 std::optional<ShiftedDcId> Instance::Private::queryRequestByDc(
 		mtpRequestId requestId) const {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		return it->second;
-	}
-	return std::nullopt;
+	return _requestsByDc.find(requestId);
 }
 
 std::optional<ShiftedDcId> Instance::Private::changeRequestByDc(
 		mtpRequestId requestId,
 		DcId newdc) {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		if (it->second < 0) {
-			it->second = -newdc;
+	return _requestsByDc.update(requestId, [&](ShiftedDcId &shiftedDcId) {
+		if (shiftedDcId < 0) {
+			shiftedDcId = -newdc;
 		} else {
-			it->second = ShiftDcId(newdc, GetDcIdShift(it->second));
+			shiftedDcId = ShiftDcId(newdc, GetDcIdShift(shiftedDcId));
 		}
-		return it->second;
-	}
-	return std::nullopt;
+	});
 }
 
 void Instance::Private::checkDelayedRequests() {
@@ -927,15 +909,10 @@ void Instance::Private::checkDelayedRequests() {
 			continue;
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
-				continue;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
+			continue;
 		}
 		const auto session = getSession(qAbs(dcWithShift));
 		session->sendPrepared(request);
@@ -976,22 +953,15 @@ void Instance::Private::sendRequest(
 void Instance::Private::registerRequest(
 		mtpRequestId requestId,
 		ShiftedDcId shiftedDcId) {
-	QMutexLocker locker(&_requestByDcLock);
-	_requestsByDc[requestId] = shiftedDcId;
+	_requestsByDc.set(requestId, shiftedDcId);
 }
 
 void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: unregistering request %1.").arg(requestId));
 
 	_requestsDelays.erase(requestId);
-
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.erase(requestId);
-	}
-
-	QMutexLocker locker(&_requestByDcLock);
-	_requestsByDc.erase(requestId);
+	_requestMap.remove(requestId);
+	_requestsByDc.remove(requestId);
 }
 
 void Instance::Private::storeRequest(
@@ -999,45 +969,26 @@ void Instance::Private::storeRequest(
 		const SerializedRequest &request,
 		ResponseHandler &&callbacks) {
 	if (callbacks.done || callbacks.fail) {
-		QMutexLocker locker(&_parserMapLock);
-		_parserMap.emplace(requestId, std::move(callbacks));
-	}
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.emplace(requestId, request);
+		_parserMap.set(requestId, std::move(callbacks));
 	}
+	_requestMap.set(requestId, request);
 }
 
 SerializedRequest Instance::Private::getRequest(mtpRequestId requestId) {
-	auto result = SerializedRequest();
-	{
-		QReadLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.cend()) {
-			result = it->second;
-		}
-	}
-	return result;
+	return _requestMap.find(requestId).value_or(SerializedRequest());
 }
 
 bool Instance::Private::hasCallback(mtpRequestId requestId) const {
-	QMutexLocker locker(&_parserMapLock);
-	auto it = _parserMap.find(requestId);
-	return (it != _parserMap.cend());
+	return _parserMap.contains(requestId);
 }
 
 void Instance::Private::processCallback(const Response &response) {
 	const auto requestId = response.requestId;
 	ResponseHandler handler;
-	{
-		QMutexLocker locker(&_parserMapLock);
-		auto it = _parserMap.find(requestId);
-		if (it != _parserMap.cend()) {
-			handler = std::move(it->second);
-			_parserMap.erase(it);
-
-			DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
-		}
+	if (auto found = _parserMap.take(requestId)) {
+		handler = std::move(*found);
+
+		DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
 	}
 	if (handler.done || handler.fail) {
 		const auto handleError = [&](const Error &error) {
@@ -1049,8 +1000,7 @@ void Instance::Private::processCallback(const Response &response) {
 			if (rpcErrorOccured(response, handler, error)) {
 				unregisterRequest(requestId);
 			} else {
-				QMutexLocker locker(&_parserMapLock);
-				_parserMap.emplace(requestId, std::move(handler));
+				_parserMap.set(requestId, std::move(handler));
 			}
 		};
 
@@ -1151,10 +1101,9 @@ void Instance::Private::importDone(
 
 	auto &waiters = _authWaiters[newdc];
 	if (waiters.size()) {
-		QReadLocker locker(&_requestMapLock);
 		for (auto waitedRequestId : waiters) {
-			auto it = _requestMap.find(waitedRequestId);
-			if (it == _requestMap.cend()) {
+			const auto request = getRequest(waitedRequestId);
+			if (!request) {
 				LOG(("MTP Error: could not find request %1 for resending").arg(waitedRequestId));
 				continue;
 			}
@@ -1167,7 +1116,7 @@ void Instance::Private::importDone(
 			}
 			DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(waitedRequestId).arg(*shiftedDcId));
 			const auto session = getSession(*shiftedDcId);
-			session->sendPrepared(it->second);
+			session->sendPrepared(request);
 		}
 		waiters.clear();
 	}
@@ -1305,15 +1254,10 @@ bool Instance::Private::onErrorDefault(
 			newdcWithShift = ShiftDcId(newdcWithShift, GetDcIdShift(dcWithShift));
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		const auto session = getSession(newdcWithShift);
 		registerRequest(
@@ -1387,15 +1331,10 @@ bool Instance::Private::onErrorDefault(
 		return true;
 	} else if (type == qstr("CONNECTION_NOT_INITED")
 		|| type == qstr("CONNECTION_LAYER_INVALID")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		auto dcWithShift = ShiftedDcId(0);
 		if (const auto shiftedDcId = queryRequestByDc(requestId)) {
@@ -1412,15 +1351,10 @@ bool Instance::Private::onErrorDefault(
 	} else if (type == qstr("CONNECTION_LANG_CODE_INVALID")) {
 		Lang::CurrentCloudManager().resetToDefault();
 	} else if (type == qstr("MSG_WAIT_FAILED")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		const auto request = getRequest(requestId);
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		if (!request->after) {
 			LOG(("MTP Error: wait failed for not dependent request %1").arg(requestId));
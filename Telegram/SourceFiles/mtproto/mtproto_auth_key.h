@@ -65,6 +65,7 @@ private:
 using AuthKeyPtr = std::shared_ptr<AuthKey>;
 using AuthKeysList = std::vector<AuthKeyPtr>;
 
+// src and dst may point to the same buffer for in place processing.
 void aesIgeEncryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv);
 void aesIgeDecryptRaw(const void *src, void *dst, uint32 len, const void *key, const void *iv);
 
@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection_tcp.h"
 #include "storage/serialize_common.h"
 #include "base/qt_adapters.h"
+#include "base/unixtime.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QRegularExpression>
@@ -21,6 +22,12 @@ namespace {
 
 using namespace details;
 
+// Don't prefer an endpoint that we didn't connect to for this long.
+constexpr auto kConnectedLifetime = 7 * 86400;
+
+// Save the same connected endpoint with a new date not more often.
+constexpr auto kConnectedSaveDelay = 86400;
+
 struct BuiltInDc {
 	int id;
 	const char *ip;
@@ -151,6 +158,7 @@ DcOptions::DcOptions(const DcOptions &other)
 , _cdnDcIds(other._cdnDcIds)
 , _publicKeys(other._publicKeys)
 , _cdnPublicKeys(other._cdnPublicKeys)
+, _connected(other._connected)
 , _immutable(other._immutable) {
 }
 
@@ -460,6 +468,14 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
+	// Connected endpoints.
+	size += sizeof(qint32);
+	for (const auto &[key, endpoint] : _connected) {
+		// id + type + proxy + protocol + port + rtt + date
+		size += 7 * sizeof(qint32);
+		size += sizeof(qint32) + endpoint.ip.size();
+	}
+
 	constexpr auto kVersion = 1;
 
 	auto result = QByteArray();
@@ -495,6 +511,21 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Connected endpoints.
+		stream << qint32(_connected.size());
+		for (const auto &[key, endpoint] : _connected) {
+			const auto &[dcId, type, throughProxy] = key;
+			stream << qint32(dcId)
+				<< qint32(type)
+				<< qint32(throughProxy ? 1 : 0)
+				<< qint32(endpoint.protocol)
+				<< qint32(endpoint.port)
+				<< qint32(endpoint.rtt)
+				<< qint32(endpoint.date)
+				<< qint32(endpoint.ip.size());
+			stream.writeRawData(endpoint.ip.data(), endpoint.ip.size());
+		}
 	}
 	return result;
 }
@@ -520,6 +551,7 @@ bool DcOptions::constructFromSerialized(const QByteArray &serialized) {
 
 	WriteLocker lock(this);
 	_data.clear();
+	_connected.clear();
 	for (auto i = 0; i != count; ++i) {
 		qint32 id = 0, flags = 0, port = 0, ipSize = 0;
 		stream >> id >> flags >> port >> ipSize;
@@ -590,6 +622,59 @@ bool DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read connected endpoints
+	if (!stream.atEnd()) {
+		auto count = qint32(0);
+		stream >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data for connected endpoints in DcOptions::constructFromSerialized()"));
+			return false;
+		}
+
+		for (auto i = 0; i != count; ++i) {
+			qint32 dcId = 0, type = 0, throughProxy = 0, protocol = 0;
+			qint32 port = 0, rtt = 0, date = 0, ipSize = 0;
+			stream
+				>> dcId
+				>> type
+				>> throughProxy
+				>> protocol
+				>> port
+				>> rtt
+				>> date
+				>> ipSize;
+
+			constexpr auto kMaxIpSize = 45;
+			if (ipSize <= 0
+				|| ipSize > kMaxIpSize
+				|| protocol < 0
+				|| protocol >= Variants::ProtocolCount
+				|| type < 0
+				|| type > int(DcType::Cdn)) {
+				LOG(("MTP Error: Bad data for connected endpoints inside DcOptions::constructFromSerialized()"));
+				return false;
+			}
+			auto ip = std::string(ipSize, ' ');
+			stream.readRawData(ip.data(), ipSize);
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad data for connected endpoints inside DcOptions::constructFromSerialized()"));
+				return false;
+			}
+			_connected.emplace(
+				std::make_tuple(
+					DcId(dcId),
+					DcType(type),
+					(throughProxy != 0)),
+				ConnectedEndpoint{
+					.ip = std::move(ip),
+					.port = port,
+					.protocol = Variants::Protocol(protocol),
+					.rtt = crl::time(rtt),
+					.date = TimeId(date),
+				});
+		}
+	}
 	return true;
 }
 
@@ -723,6 +808,45 @@ auto DcOptions::lookup(
 	return result;
 }
 
+void DcOptions::rememberConnected(
+		DcId dcId,
+		DcType type,
+		bool throughProxy,
+		ConnectedEndpoint endpoint) {
+	if (type == DcType::Temporary || isTemporaryDcId(dcId)) {
+		return;
+	}
+	WriteLocker lock(this);
+	auto &was = _connected[std::make_tuple(dcId, type, throughProxy)];
+	const auto changed = (was.ip != endpoint.ip)
+		|| (was.port != endpoint.port)
+		|| (was.protocol != endpoint.protocol)
+		|| (endpoint.date - was.date > kConnectedSaveDelay);
+	was = std::move(endpoint);
+	lock.unlock();
+
+	if (changed) {
+		_connectedChanged.fire({});
+	}
+}
+
+auto DcOptions::lookupConnected(
+		DcId dcId,
+		DcType type,
+		bool throughProxy) const -> std::optional<ConnectedEndpoint> {
+	ReadLocker lock(this);
+	const auto i = _connected.find(std::make_tuple(dcId, type, throughProxy));
+	if (i == end(_connected)
+		|| base::unixtime::now() - i->second.date > kConnectedLifetime) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+rpl::producer<> DcOptions::connectedChanged() const {
+	return _connectedChanged.events();
+}
+
 bool DcOptions::hasMediaOnlyOptionsFor(DcId dcId) const {
 	ReadLocker lock(this);
 	const auto i = _data.find(dcId);
@@ -106,6 +106,26 @@ public:
 		bool throughProxy) const;
 	[[nodiscard]] DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// The endpoint that won the last connection race to a dc, it is tried
+	// first next time and used without waiting for a better one.
+	struct ConnectedEndpoint {
+		std::string ip;
+		int port = 0;
+		Variants::Protocol protocol = Variants::Tcp;
+		crl::time rtt = 0;
+		TimeId date = 0;
+	};
+	void rememberConnected(
+		DcId dcId,
+		DcType type,
+		bool throughProxy,
+		ConnectedEndpoint endpoint);
+	[[nodiscard]] std::optional<ConnectedEndpoint> lookupConnected(
+		DcId dcId,
+		DcType type,
+		bool throughProxy) const;
+	[[nodiscard]] rpl::producer<> connectedChanged() const;
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	[[nodiscard]] bool hasCDNKeysForDc(DcId dcId) const;
 	[[nodiscard]] details::RSAPublicKey getDcRSAKey(
@@ -155,10 +175,14 @@ private:
 	base::flat_map<
 		DcId,
 		base::flat_map<uint64, details::RSAPublicKey>> _cdnPublicKeys;
+	base::flat_map<
+		std::tuple<DcId, DcType, bool>,
+		ConnectedEndpoint> _connected;
 	mutable QReadWriteLock _useThroughLockers;
 
 	rpl::event_stream<DcId> _changed;
 	rpl::event_stream<> _cdnConfigChanged;
+	rpl::event_stream<> _connectedChanged;
 
 	// True when we have overriden options from a .tdesktop-endpoints file.
 	bool _immutable = false;
@@ -28,6 +28,7 @@ namespace {
 
 constexpr auto kIntSize = static_cast<int>(sizeof(mtpPrime));
 constexpr auto kWaitForBetterTimeout = crl::time(2000);
+constexpr auto kPreferredConnectionPriority = 4;
 constexpr auto kMinConnectedTimeout = crl::time(1000);
 constexpr auto kMaxConnectedTimeout = crl::time(8000);
 constexpr auto kMinReceiveTimeout = crl::time(4000);
@@ -43,6 +44,7 @@ constexpr auto kCheckSentRequestsEach = 1 * crl::time(1000);
 constexpr auto kKeyOldEnoughForDestroy = 60 * crl::time(1000);
 constexpr auto kSentContainerLives = 600 * crl::time(1000);
 constexpr auto kFastRequestDuration = crl::time(500);
+constexpr auto kSendStatsPeriod = 60 * crl::time(1000);
 
 // If we can't connect for this time we will ask _instance to update config.
 constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
@@ -186,12 +188,16 @@ void SessionPrivate::appendTestConnection(
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret) {
+		const bytes::vector &protocolSecret,
+		bool preferred) {
 	QWriteLocker lock(&_stateMutex);
 
-	const auto priority = (qthelp::is_ipv6(ip) ? 0 : 1)
-		+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
-		+ (protocolSecret.empty() ? 0 : 1);
+	// The endpoint we connected to last time beats all computed priorities.
+	const auto priority = preferred
+		? kPreferredConnectionPriority
+		: ((qthelp::is_ipv6(ip) ? 0 : 1)
+			+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
+			+ (protocolSecret.empty() ? 0 : 1));
 	_testConnections.push_back({
 		AbstractConnection::Create(
 			_instance,
@@ -199,7 +205,10 @@ void SessionPrivate::appendTestConnection(
 			thread(),
 			protocolSecret,
 			_options->proxy),
-		priority
+		priority,
+		ip,
+		port,
+		protocol,
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -680,6 +689,7 @@ void SessionPrivate::tryToSend() {
 
 	bool needAnyResponse = false;
 	SerializedRequest toSendRequest;
+	auto toSendMessages = 0;
 	{
 		QWriteLocker locker1(_sessionData->toSendMutex());
 
@@ -702,6 +712,7 @@ void SessionPrivate::tryToSend() {
 		if (!toSendCount) {
 			return; // nothing to send
 		}
+		toSendMessages = toSendCount;
 
 		const auto first = pingRequest
 			? pingRequest
@@ -924,9 +935,33 @@ void SessionPrivate::tryToSend() {
 			_sentContainers.emplace(containerMsgId, std::move(sentIdsWrap));
 		}
 	}
+	countSentPacket(toSendMessages, toSendRequest->size());
 	sendSecureRequest(std::move(toSendRequest), needAnyResponse);
 }
 
+void SessionPrivate::countSentPacket(int messages, int ints) {
+	const auto now = crl::now();
+	if (!_sendStats.started) {
+		_sendStats.started = now;
+	}
+	++_sendStats.packets;
+	_sendStats.messages += messages;
+	_sendStats.bytes += ints * sizeof(mtpPrime);
+
+	const auto duration = now - _sendStats.started;
+	if (duration < kSendStatsPeriod) {
+		return;
+	}
+	const auto packets = _sendStats.packets;
+	DEBUG_LOG(("MTP Info: dc %1 sent %2 packets per second, "
+		"%3 messages and %4 bytes per packet."
+		).arg(_shiftedDcId
+		).arg(packets * 1000. / duration, 0, 'f', 2
+		).arg(_sendStats.messages / double(packets), 0, 'f', 2
+		).arg(_sendStats.bytes / packets));
+	_sendStats = SendStats();
+}
+
 void SessionPrivate::retryByTimer() {
 	if (_retryTimeout < 3) {
 		++_retryTimeout;
@@ -973,10 +1008,21 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 	} else {
 		using Variants = DcOptions::Variants;
 		const auto special = (_currentDcType == DcType::Temporary);
+		const auto throughProxy = (_options->proxy.type
+			!= ProxyData::Type::None);
 		const auto variants = _instance->dcOptions().lookup(
 			bareDc,
 			_currentDcType,
-			_options->proxy.type != ProxyData::Type::None);
+			throughProxy);
+
+		// Trust the last winner only if it didn't take longer than we wait.
+		auto connected = _instance->dcOptions().lookupConnected(
+			bareDc,
+			_currentDcType,
+			throughProxy);
+		if (connected && connected->rtt >= kWaitForBetterTimeout) {
+			connected = std::nullopt;
+		}
 		const auto useIPv4 = special ? true : _options->useIPv4;
 		const auto useIPv6 = special ? false : _options->useIPv6;
 		const auto useTcp = special ? true : _options->useTcp;
@@ -1000,11 +1046,16 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 					continue;
 				}
 				for (const auto &endpoint : variants.data[address][protocol]) {
+					const auto preferred = connected
+						&& (connected->protocol == protocol)
+						&& (connected->ip == endpoint.ip)
+						&& (connected->port == endpoint.port);
 					appendTestConnection(
 						static_cast<Variants::Protocol>(protocol),
 						QString::fromStdString(endpoint.ip),
 						endpoint.port,
-						endpoint.secret);
+						endpoint.secret,
+						preferred);
 				}
 			}
 		}
@@ -1221,7 +1272,9 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
 		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
 		auto intsCount = uint32(intsBuffer.size());
-		auto ints = intsBuffer.constData();
+
+		// The received buffer is ours, it is decrypted in place.
+		auto ints = intsBuffer.data();
 		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
 			LOG(("TCP Error: bad message received, len %1").arg(intsCount * kIntSize));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
@@ -1235,19 +1288,21 @@ void SessionPrivate::handleReceived() {
 			return restart();
 		}
 
-		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
 		auto msgKey = *(MTPint128*)(ints + 2);
 
+		// The buffer holds plaintext after this, only the external header
+		// (auth_key_id and msg_key) may be dumped to the logs below.
+		const auto encryptedInts = ints + kExternalHeaderIntsCount;
 #ifdef TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt_oldmtp(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
+		aesIgeDecrypt_oldmtp(encryptedInts, encryptedInts, encryptedBytesCount, _encryptionKey, msgKey);
 #else // TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, _encryptionKey, msgKey);
+		aesIgeDecrypt(encryptedInts, encryptedInts, encryptedBytesCount, _encryptionKey, msgKey);
 #endif // TDESKTOP_MTPROTO_OLD
 
-		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
+		const auto decryptedInts = static_cast<const mtpPrime*>(
+			encryptedInts);
 		auto serverSalt = *(uint64*)&decryptedInts[0];
 		auto session = *(uint64*)&decryptedInts[2];
 		auto msgId = *(uint64*)&decryptedInts[4];
@@ -1257,7 +1312,7 @@ void SessionPrivate::handleReceived() {
 		auto messageLength = *(uint32*)&decryptedInts[7];
 		if (messageLength > kMaxMessageLength) {
 			LOG(("TCP Error: bad messageLength %1").arg(messageLength));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(ints, intsCount * kIntSize).str()));
+			TCP_LOG(("TCP Error: bad message, header %1, encrypted len %2").arg(Logs::mb(ints, kExternalHeaderIntsCount * kIntSize).str()).arg(encryptedBytesCount));
 
 			return restart();
 
@@ -1278,7 +1333,7 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMsgKeyShift_oldmtp = 4U;
 		if (ConstTimeIsDifferent(&msgKey, sha1ForMsgKeyCheck.data() + kMsgKeyShift_oldmtp, sizeof(msgKey))) {
 			LOG(("TCP Error: bad SHA1 hash after aesDecrypt in message."));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+			TCP_LOG(("TCP Error: bad message, header %1, encrypted len %2").arg(Logs::mb(ints, kExternalHeaderIntsCount * kIntSize).str()).arg(encryptedBytesCount));
 
 			return restart();
 		}
@@ -1298,7 +1353,7 @@ void SessionPrivate::handleReceived() {
 		constexpr auto kMsgKeyShift = 8U;
 		if (ConstTimeIsDifferent(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey))) {
 			LOG(("TCP Error: bad SHA256 hash after aesDecrypt in message"));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+			TCP_LOG(("TCP Error: bad message, header %1, encrypted len %2").arg(Logs::mb(ints, kExternalHeaderIntsCount * kIntSize).str()).arg(encryptedBytesCount));
 
 			return restart();
 		}
@@ -1306,7 +1361,7 @@ void SessionPrivate::handleReceived() {
 
 		if (badMessageLength || (messageLength & 0x03)) {
 			LOG(("TCP Error: bad msg_len received %1, data size: %2").arg(messageLength).arg(encryptedBytesCount));
-			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
+			TCP_LOG(("TCP Error: bad message, header %1, encrypted len %2").arg(Logs::mb(ints, kExternalHeaderIntsCount * kIntSize).str()).arg(encryptedBytesCount));
 
 			return restart();
 		}
@@ -2280,8 +2335,10 @@ void SessionPrivate::onConnected(
 			j->data->tag()));
 		_waitForBetterTimer.callOnce(kWaitForBetterTimeout);
 	} else {
-		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
+		DEBUG_LOG(("MTP Info: connection %1 succeed, using it.").arg(
+			i->data->tag()));
 		_waitForBetterTimer.cancel();
+		rememberConnection(*i);
 		_connection = std::move(i->data);
 		_testConnections.clear();
 		checkAuthKey();
@@ -2318,12 +2375,37 @@ void SessionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
+	rememberConnection(*i);
 	_connection = std::move(i->data);
 	_testConnections.clear();
 
 	checkAuthKey();
 }
 
+void SessionPrivate::rememberConnection(const TestConnection &test) {
+	if (test.ip.isEmpty()) {
+		// Connecting through an MTProto proxy, endpoint is in the proxy.
+		return;
+	}
+	const auto dcId = BareDcId(_shiftedDcId);
+	const auto type = _currentDcType;
+	const auto throughProxy = (_options->proxy.type != ProxyData::Type::None);
+	const auto endpoint = DcOptions::ConnectedEndpoint{
+		.ip = test.ip.toStdString(),
+		.port = test.port,
+		.protocol = test.protocol,
+		.rtt = test.data->pingTime(),
+		.date = base::unixtime::now(),
+	};
+	InvokeQueued(_instance, [=, instance = _instance] {
+		instance->dcOptions().rememberConnected(
+			dcId,
+			type,
+			throughProxy,
+			endpoint);
+	});
+}
+
 void SessionPrivate::removeTestConnection(
 		not_null<AbstractConnection*> connection) {
 	_testConnections.erase(
@@ -57,11 +57,20 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		QString ip;
+		int port = 0;
+		DcOptions::Variants::Protocol protocol = DcOptions::Variants::Tcp;
 	};
 	struct SentContainer {
 		crl::time sent = 0;
 		std::vector<mtpMsgId> messages;
 	};
+	struct SendStats {
+		crl::time started = 0;
+		int packets = 0;
+		int messages = 0;
+		int64 bytes = 0;
+	};
 	enum class HandleResult {
 		Success,
 		Ignored,
@@ -96,6 +105,7 @@ private:
 	void destroyAllConnections();
 
 	void confirmBestConnection();
+	void rememberConnection(const TestConnection &test);
 	void removeTestConnection(not_null<AbstractConnection*> connection);
 	[[nodiscard]] int16 getProtocolDcId() const;
 
@@ -118,6 +128,7 @@ private:
 	bool sendSecureRequest(
 		SerializedRequest &&request,
 		bool needAnyResponse);
+	void countSentPacket(int messages, int ints);
 	mtpRequestId wasSent(mtpMsgId msgId) const;
 
 	struct OuterInfo {
@@ -144,7 +155,8 @@ private:
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret);
+		const bytes::vector &protocolSecret,
+		bool preferred = false);
 
 	// if badTime received - search for ids in sessionData->haveSent and sessionData->wereAcked and sync time/salt, return true if found
 	bool requestsFixTimeSalt(const QVector<MTPlong> &ids, const OuterInfo &info);
@@ -218,6 +230,7 @@ private:
 	mtpMsgId _pingMsgId = 0;
 	base::Timer _pingSender;
 	base::Timer _checkSentRequestsTimer;
+	SendStats _sendStats;
 
 	std::shared_ptr<SessionData> _sessionData;
 	std::unique_ptr<SessionOptions> _options;
@@ -30,12 +30,29 @@ constexpr auto kMaxTrackedSuccesses = kRetryAddSessionSuccesses
 constexpr auto kRemoveSessionAfterTimeouts = 4;
 constexpr auto kResetDownloadPrioritiesTimeout = crl::time(200);
 constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
+constexpr auto kAutoLoadingBytesLimit = 16 * 1024 * 1024;
+constexpr auto kAutoLoadingRecentTimeout = crl::time(1000);
+
+// Admitted automatic downloads go after the explicit requests of the
+// current generation, together with the older ones (see resetGeneration).
+constexpr auto kAutoLoadingPriority = -1;
 
 // Each (session remove by timeouts) we wait for time:
 // kRetryAddSessionTimeout * max(removesCount, kMaxTrackedSessionRemoves)
 // and for successes in all remaining sessions:
 // kRetryAddSessionSuccesses * max(removesCount, kMaxTrackedSessionRemoves)
 
+[[nodiscard]] int AutoLoadingImportance(const Data::FileOrigin &origin) {
+	return v::match(origin.data, [](const Data::FileOriginMessage &data) {
+		// Messages from channels and supergroups go after private chats.
+		return data.channel ? 1 : 0;
+	}, [](v::null_t) {
+		return 2;
+	}, [](const auto &) {
+		return 0;
+	});
+}
+
 } // namespace
 
 void DownloadManagerMtproto::Queue::enqueue(
@@ -80,6 +97,10 @@ bool DownloadManagerMtproto::Queue::empty() const {
 	return _tasks.empty();
 }
 
+bool DownloadManagerMtproto::Queue::contains(not_null<Task*> task) const {
+	return ranges::contains(_tasks, task, &Enqueued::task);
+}
+
 auto DownloadManagerMtproto::Queue::nextTask(bool onlyHighestPriority) const
 -> Task* {
 	if (_tasks.empty()) {
@@ -118,7 +139,8 @@ DownloadManagerMtproto::DcBalanceData::DcBalanceData()
 DownloadManagerMtproto::DownloadManagerMtproto(not_null<ApiWrap*> api)
 : _api(api)
 , _resetGenerationTimer([=] { resetGeneration(); })
-, _killSessionsTimer([=] { killSessions(); }) {
+, _killSessionsTimer([=] { killSessions(); })
+, _autoLoadingTimer([=] { checkAutoLoading(); }) {
 	_api->instance().restartsByTimeout(
 	) | rpl::filter([](MTP::ShiftedDcId shiftedDcId) {
 		return MTP::isDownloadDcId(shiftedDcId);
@@ -147,9 +169,147 @@ void DownloadManagerMtproto::remove(not_null<Task*> task) {
 	const auto dcId = task->dcId();
 	auto &queue = _queues[dcId];
 	queue.remove(task);
+	removeAutoLoading(task);
 	checkSendNext(dcId, queue);
 }
 
+void DownloadManagerMtproto::enqueueAutoLoading(
+		not_null<Task*> task,
+		int size) {
+	if (_autoLoadingActive.contains(task)) {
+		enqueue(task, kAutoLoadingPriority);
+		return;
+	} else if (_queues[task->dcId()].contains(task)) {
+		enqueue(task, 0);
+		return;
+	}
+	const auto now = crl::now();
+	const auto i = ranges::find(
+		_autoLoadingWaiting,
+		task,
+		&AutoLoading::task);
+	if (i != end(_autoLoadingWaiting)) {
+		i->size = size;
+		i->requested = now;
+	} else {
+		_autoLoadingWaiting.push_back({
+			.task = task,
+			.size = size,
+			.importance = AutoLoadingImportance(task->fileOrigin()),
+			.requested = now,
+		});
+	}
+	checkAutoLoading();
+}
+
+void DownloadManagerMtproto::refreshAutoLoading(
+		not_null<Task*> task,
+		int addedSize) {
+	const auto i = ranges::find(
+		_autoLoadingWaiting,
+		task,
+		&AutoLoading::task);
+	if (i != end(_autoLoadingWaiting)) {
+		// Views request the files they paint again and again, so the
+		// ones visible right now are ordered first in the next check.
+		i->size += addedSize;
+		i->requested = crl::now();
+		if (!_autoLoadingTimer.isActive()) {
+			_autoLoadingTimer.callOnce(0);
+		}
+		return;
+	}
+	const auto j = _autoLoadingActive.find(task);
+	if (j != end(_autoLoadingActive) && addedSize > 0) {
+		j->second += addedSize;
+		_autoLoadingActiveBytes += addedSize;
+		checkSendNext(task->dcId(), _queues[task->dcId()]);
+	}
+}
+
+void DownloadManagerMtproto::prioritize(not_null<Task*> task) {
+	const auto tracked = _autoLoadingActive.contains(task)
+		|| ranges::contains(_autoLoadingWaiting, task, &AutoLoading::task);
+	removeAutoLoading(task);
+	if (tracked) {
+		enqueue(task, 0);
+	}
+}
+
+AutoLoadingStats DownloadManagerMtproto::autoLoadingStats() const {
+	return {
+		.waiting = int(_autoLoadingWaiting.size()),
+		.active = int(_autoLoadingActive.size()),
+		.activeBytes = _autoLoadingActiveBytes,
+		.paused = autoLoadingPaused(),
+	};
+}
+
+void DownloadManagerMtproto::removeAutoLoading(not_null<Task*> task) {
+	_autoLoadingWaiting.erase(
+		ranges::remove(_autoLoadingWaiting, task, &AutoLoading::task),
+		end(_autoLoadingWaiting));
+	const auto i = _autoLoadingActive.find(task);
+	if (i != end(_autoLoadingActive)) {
+		_autoLoadingActiveBytes -= i->second;
+		_autoLoadingActive.erase(i);
+		crl::on_main(this, [=] {
+			checkAutoLoading();
+		});
+	}
+}
+
+bool DownloadManagerMtproto::autoLoadingPaused() const {
+	// Don't add automatic downloads while sessions are timing out.
+	const auto now = crl::now();
+	return ranges::any_of(_balanceData, [&](const auto &pair) {
+		const auto &dc = pair.second;
+		return (dc.timeouts > 0)
+			|| (dc.lastSessionRemove > 0
+				&& now - dc.lastSessionRemove < kRetryAddSessionTimeout);
+	});
+}
+
+void DownloadManagerMtproto::checkAutoLoading() {
+	if (_autoLoadingWaiting.empty()) {
+		return;
+	}
+	const auto now = crl::now();
+	const auto paused = autoLoadingPaused();
+	ranges::sort(_autoLoadingWaiting, ranges::less(), [&](
+			const AutoLoading &entry) {
+		const auto recent = (now - entry.requested
+			< kAutoLoadingRecentTimeout);
+		return std::make_tuple(
+			!recent,
+			entry.importance,
+			entry.size,
+			-entry.requested);
+	});
+	while (!_autoLoadingWaiting.empty()) {
+		const auto first = _autoLoadingWaiting.front();
+		if (!_autoLoadingActive.empty()
+			&& (paused
+				|| (_autoLoadingActiveBytes + first.size
+					> kAutoLoadingBytesLimit))) {
+			break;
+		}
+		_autoLoadingWaiting.erase(begin(_autoLoadingWaiting));
+		_autoLoadingActive.emplace(first.task, first.size);
+		_autoLoadingActiveBytes += first.size;
+		enqueue(first.task, kAutoLoadingPriority);
+	}
+	if (paused && !_autoLoadingWaiting.empty()) {
+		_autoLoadingTimer.callOnce(kRetryAddSessionTimeout);
+	}
+	DEBUG_LOG(("Download Info: Auto-loading "
+		"%1 waiting, %2 active (%3 bytes)%4."
+		).arg(_autoLoadingWaiting.size()
+		).arg(_autoLoadingActive.size()
+		).arg(_autoLoadingActiveBytes
+		).arg(paused ? ", paused" : ""));
+}
+
 void DownloadManagerMtproto::resetGeneration() {
 	_resetGenerationTimer.cancel();
 	for (auto &[dcId, queue] : _queues) {
@@ -868,6 +1028,18 @@ void DownloadMtprotoTask::addToQueue(int priority) {
 	_owner->enqueue(this, priority);
 }
 
+void DownloadMtprotoTask::addToAutoLoadingQueue(int size) {
+	_owner->enqueueAutoLoading(this, size);
+}
+
+void DownloadMtprotoTask::refreshInAutoLoadingQueue(int addedSize) {
+	_owner->refreshAutoLoading(this, addedSize);
+}
+
+void DownloadMtprotoTask::prioritizeInQueue() {
+	_owner->prioritize(this);
+}
+
 void DownloadMtprotoTask::removeFromQueue() {
 	_owner->remove(this);
 }
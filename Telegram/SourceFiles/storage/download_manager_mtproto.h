@@ -27,6 +27,13 @@ constexpr auto kDownloadPartSize = 128 * 1024;
 
 class DownloadMtprotoTask;
 
+struct AutoLoadingStats {
+	int waiting = 0;
+	int active = 0;
+	int64 activeBytes = 0;
+	bool paused = false;
+};
+
 class DownloadManagerMtproto final : public base::has_weak_ptr {
 public:
 	using Task = DownloadMtprotoTask;
@@ -41,6 +48,13 @@ public:
 	void enqueue(not_null<Task*> task, int priority);
 	void remove(not_null<Task*> task);
 
+	// Automatic downloads wait until they fit in the in-flight bytes limit,
+	// the ones requested recently, from private chats and smaller go first.
+	void enqueueAutoLoading(not_null<Task*> task, int size);
+	void refreshAutoLoading(not_null<Task*> task, int addedSize);
+	void prioritize(not_null<Task*> task);
+	[[nodiscard]] AutoLoadingStats autoLoadingStats() const;
+
 	void notifyTaskFinished() {
 		_taskFinished.fire({});
 	}
@@ -64,6 +78,7 @@ private:
 		void remove(not_null<Task*> task);
 		void resetGeneration();
 		[[nodiscard]] bool empty() const;
+		[[nodiscard]] bool contains(not_null<Task*> task) const;
 		[[nodiscard]] Task *nextTask(bool onlyHighestPriority) const;
 		void removeSession(int index);
 
@@ -92,6 +107,12 @@ private:
 		int timeouts = 0; // Since all sessions had successes >= required.
 		int totalRequested = 0;
 	};
+	struct AutoLoading {
+		not_null<Task*> task;
+		int size = 0;
+		int importance = 0;
+		crl::time requested = 0;
+	};
 
 	void checkSendNext();
 	void checkSendNext(MTP::DcId dcId, Queue &queue);
@@ -104,6 +125,10 @@ private:
 
 	void resetGeneration();
 	void sessionTimedOut(MTP::DcId dcId, int index);
+
+	void checkAutoLoading();
+	void removeAutoLoading(not_null<Task*> task);
+	[[nodiscard]] bool autoLoadingPaused() const;
 	void removeSession(MTP::DcId dcId);
 
 	const not_null<ApiWrap*> _api;
@@ -117,6 +142,12 @@ private:
 	base::Timer _killSessionsTimer;
 
 	base::flat_map<MTP::DcId, Queue> _queues;
+
+	std::vector<AutoLoading> _autoLoadingWaiting;
+	base::flat_map<not_null<Task*>, int> _autoLoadingActive;
+	int64 _autoLoadingActiveBytes = 0;
+	base::Timer _autoLoadingTimer;
+
 	rpl::lifetime _lifetime;
 
 };
@@ -161,6 +192,9 @@ protected:
 	void cancelRequestForOffset(int offset);
 
 	void addToQueue(int priority = 0);
+	void addToAutoLoadingQueue(int size);
+	void refreshInAutoLoadingQueue(int addedSize);
+	void prioritizeInQueue();
 	void removeFromQueue();
 
 	[[nodiscard]] ApiWrap &api() const {
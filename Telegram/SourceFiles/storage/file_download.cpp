@@ -15,7 +15,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/application.h"
 #include "core/file_location.h"
 #include "storage/storage_account.h"
+#include "storage/file_download_decoder.h"
 #include "storage/file_download_mtproto.h"
+#include "storage/file_download_sink.h"
 #include "storage/file_download_web.h"
 #include "platform/platform_file_utilities.h"
 #include "main/main_session.h"
@@ -106,7 +108,6 @@ FileLoader::FileLoader(
 , _autoLoading(autoLoading)
 , _cacheTag(cacheTag)
 , _filename(toFile)
-, _file(_filename)
 , _toCache(toCache)
 , _fromCloud(fromCloud)
 , _loadSize(loadSize)
@@ -128,28 +129,17 @@ void FileLoader::finishWithBytes(const QByteArray &data) {
 	_data = data;
 	_localStatus = LocalStatus::Loaded;
 	if (!_filename.isEmpty() && _toCache == LoadToCacheAsWell) {
-		if (!_fileIsOpen) _fileIsOpen = _file.open(QIODevice::WriteOnly);
-		if (!_fileIsOpen) {
-			cancel(true);
-			return;
-		}
-		_file.seek(0);
-		if (_file.write(_data) != qint64(_data.size())) {
-			cancel(true);
+		if (!_sink && !openSink()) {
 			return;
 		}
+		_sink->write(0, base::duplicate(_data));
 	}
-
-	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
-		Platform::File::PostprocessDownloaded(
-			QFileInfo(_file).absoluteFilePath());
-	}
-	const auto session = _session;
-	_updates.fire_done();
-	session->notifyDownloaderTaskFinished();
+	finishSink([=] {
+		_finished = true;
+		const auto session = _session;
+		_updates.fire_done();
+		session->notifyDownloaderTaskFinished();
+	});
 }
 
 QImage FileLoader::imageData(int progressiveSizeLimit) const {
@@ -188,7 +178,6 @@ bool FileLoader::setFileName(const QString &fileName) {
 		return fileName.isEmpty() || (fileName == _filename);
 	}
 	_filename = fileName;
-	_file.setFileName(_filename);
 	return true;
 }
 
@@ -200,8 +189,29 @@ void FileLoader::increaseLoadSize(int size, bool autoLoading) {
 	Expects(size > _loadSize);
 	Expects(size <= _fullSize);
 
+	const auto added = size - _loadSize;
 	_loadSize = size;
-	_autoLoading = autoLoading;
+	if (_finishing) {
+		return;
+	} else if (autoLoading) {
+		_autoLoading = true;
+		refreshAutoLoadingHook(added);
+	} else {
+		stopAutoLoading();
+	}
+}
+
+void FileLoader::refreshAutoLoading() {
+	if (_autoLoading && !_finished && !_finishing) {
+		refreshAutoLoadingHook(0);
+	}
+}
+
+void FileLoader::stopAutoLoading() {
+	if (_autoLoading) {
+		_autoLoading = false;
+		stopAutoLoadingHook();
+	}
 }
 
 void FileLoader::notifyAboutProgress() {
@@ -239,7 +249,7 @@ void FileLoader::localLoaded(
 }
 
 void FileLoader::start() {
-	if (_finished || tryLoadLocal()) {
+	if (_finished || _finishing || tryLoadLocal()) {
 		return;
 	} else if (_fromCloud == LoadFromLocalOnly) {
 		cancel();
@@ -254,23 +264,58 @@ void FileLoader::start() {
 bool FileLoader::checkForOpen() {
 	if (_filename.isEmpty()
 		|| (_toCache != LoadToFileOnly)
-		|| _fileIsOpen) {
+		|| _sink) {
 		return true;
 	}
-	_fileIsOpen = _file.open(QIODevice::WriteOnly);
-	if (_fileIsOpen) {
+	return openSink();
+}
+
+bool FileLoader::openSink() {
+	Expects(!_sink);
+
+	_sink = std::make_unique<Storage::FileDownloadSink>(_filename, [=] {
+		if (!_finished) {
+			cancel(true);
+		}
+	});
+	if (_sink->open(_fullSize)) {
 		return true;
 	}
+	_sink = nullptr;
 	cancel(true);
 	return false;
 }
 
+void FileLoader::finishSink(Fn<void()> done) {
+	if (!_sink) {
+		done();
+		return;
+	}
+	// Not called if the sink is taken by cancel() in the meantime.
+	_finishing = true;
+	_sink->finish([=](bool success) {
+		_finishing = false;
+		if (!success) {
+			cancel(true);
+			return;
+		}
+		_sink = nullptr;
+		Platform::File::PostprocessDownloaded(
+			QFileInfo(_filename).absoluteFilePath());
+		done();
+	});
+}
+
 void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 	const auto readImage = (_locationType != AudioFileLocation);
-	auto done = [=, guard = _localLoading.make_guard()](
+	const auto priority = _autoLoading
+		? Storage::DecodePriority::Background
+		: Storage::DecodePriority::Visible;
+	auto done = [=](
 			QByteArray &&value,
 			QImage &&image,
-			QByteArray &&format) mutable {
+			QByteArray &&format,
+			base::binary_guard &&guard) {
 		crl::on_main(std::move(guard), [
 			=,
 			value = std::move(value),
@@ -283,26 +328,19 @@ void FileLoader::loadLocal(const Storage::Cache::Key &key) {
 				std::move(image));
 		});
 	};
-	_session->data().cache().get(key, [=, callback = std::move(done)](
-			QByteArray &&value) mutable {
+	_session->data().cache().get(key, [
+		=,
+		guard = _localLoading.make_guard()
+	](QByteArray &&value) mutable {
 		if (readImage && !value.startsWith("partial:")) {
-			crl::async([
-				value = std::move(value),
-				done = std::move(callback)
-			]() mutable {
-				auto format = QByteArray();
-				auto image = App::readImage(value, &format, false);
-				if (!image.isNull()) {
-					done(
-						std::move(value),
-						std::move(image),
-						std::move(format));
-				} else {
-					done(std::move(value), {}, {});
-				}
+			Storage::DecodeCachedImage({
+				.data = std::move(value),
+				.priority = priority,
+				.guard = std::move(guard),
+				.done = done,
 			});
 		} else {
-			callback(std::move(value), {}, {});
+			done(std::move(value), {}, {}, std::move(guard));
 		}
 	});
 }
@@ -343,11 +381,13 @@ void FileLoader::cancel(bool fail) {
 
 	_cancelled = true;
 	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
-		_file.remove();
+	if (const auto sink = base::take(_sink)) {
+		// All the data is received, let the file be completed.
+		if (!_finishing || fail) {
+			sink->remove();
+		}
 	}
+	_finishing = false;
 	_data = QByteArray();
 
 	const auto weak = base::make_weak(this);
@@ -358,12 +398,11 @@ void FileLoader::cancel(bool fail) {
 	}
 	if (weak) {
 		_filename = QString();
-		_file.setFileName(_filename);
 	}
 }
 
 int FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	return (_sink ? _sink->size() : _data.size()) - _skippedBytes;
 }
 
 bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
@@ -372,18 +411,15 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 	if (buffer.empty()) {
 		return true;
 	}
-	if (_fileIsOpen) {
-		auto fsize = _file.size();
+	if (_sink) {
+		const auto fsize = _sink->size();
 		if (offset < fsize) {
 			_skippedBytes -= buffer.size();
 		} else if (offset > fsize) {
 			_skippedBytes += offset - fsize;
 		}
-		_file.seek(offset);
-		if (_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) != qint64(buffer.size())) {
-			cancel(true);
-			return false;
-		}
+		// Write errors are reported asynchronously through cancel(true).
+		_sink->write(offset, buffer);
 		return true;
 	}
 	_data.reserve(offset + buffer.size());
@@ -409,20 +445,8 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
-	if (_fileIsOpen) {
-		if (_file.openMode() == QIODevice::WriteOnly) {
-			_file.close();
-			_fileIsOpen = _file.open(QIODevice::ReadWrite);
-			if (!_fileIsOpen) {
-				cancel(true);
-				return QByteArray();
-			}
-		}
-		if (!_file.seek(offset)) {
-			return QByteArray();
-		}
-		auto result = _file.read(size);
-		return (result.size() == size) ? result : QByteArray();
+	if (_sink) {
+		return _sink->read(offset, size);
 	}
 	return (offset + size <= _data.size())
 		? _data.mid(offset, size)
@@ -433,47 +457,39 @@ bool FileLoader::finalizeResult() {
 	Expects(!_finished);
 
 	if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
-		if (!_fileIsOpen) {
-			_fileIsOpen = _file.open(QIODevice::WriteOnly);
-		}
-		_file.seek(0);
-		if (!_fileIsOpen || _file.write(_data) != qint64(_data.size())) {
-			cancel(true);
+		if (!_sink && !openSink()) {
 			return false;
 		}
+		_sink->write(0, base::duplicate(_data));
 	}
-
-	_finished = true;
-	if (_fileIsOpen) {
-		_file.close();
-		_fileIsOpen = false;
-		Platform::File::PostprocessDownloaded(
-			QFileInfo(_file).absoluteFilePath());
-	}
-	if (_localStatus == LocalStatus::NotFound) {
-		if (const auto key = fileLocationKey()) {
-			if (!_filename.isEmpty()) {
-				_session->local().writeFileLocation(
-					*key,
-					Core::FileLocation(_filename));
+	finishSink([=] {
+		_finished = true;
+		if (_localStatus == LocalStatus::NotFound) {
+			if (const auto key = fileLocationKey()) {
+				if (!_filename.isEmpty()) {
+					_session->local().writeFileLocation(
+						*key,
+						Core::FileLocation(_filename));
+				}
+			}
+			const auto key = cacheKey();
+			if ((_toCache == LoadToCacheAsWell)
+				&& (_data.size() <= Storage::kMaxFileInMemory)
+				&& (key.low || key.high)) {
+				_session->data().cache().put(
+					cacheKey(),
+					Storage::Cache::Database::TaggedValue(
+						base::duplicate(
+							(!_fullSize || _data.size() == _fullSize)
+								? _data
+								: ("partial:" + _data)),
+						_cacheTag));
 			}
 		}
-		const auto key = cacheKey();
-		if ((_toCache == LoadToCacheAsWell)
-			&& (_data.size() <= Storage::kMaxFileInMemory)
-			&& (key.low || key.high)) {
-			_session->data().cache().put(
-				cacheKey(),
-				Storage::Cache::Database::TaggedValue(
-					base::duplicate((!_fullSize || _data.size() == _fullSize)
-						? _data
-						: ("partial:" + _data)),
-					_cacheTag));
-		}
-	}
-	const auto session = _session;
-	_updates.fire_done();
-	session->notifyDownloaderTaskFinished();
+		const auto session = _session;
+		_updates.fire_done();
+		session->notifyDownloaderTaskFinished();
+	});
 	return true;
 }
 
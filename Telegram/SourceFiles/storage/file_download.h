@@ -27,6 +27,8 @@ namespace Cache {
 struct Key;
 } // namespace Cache
 
+class FileDownloadSink;
+
 // 10 MB max file could be hold in memory
 // This value is used in local cache database settings!
 constexpr auto kMaxFileInMemory = 10 * 1024 * 1024;
@@ -99,6 +101,8 @@ public:
 	bool setFileName(const QString &filename); // set filename for loaders to cache
 	void permitLoadFromCloud();
 	void increaseLoadSize(int size, bool autoLoading);
+	void stopAutoLoading(); // Requested explicitly, don't wait in queue.
+	void refreshAutoLoading(); // Requested again by a view painting it.
 
 	void start();
 	void cancel();
@@ -134,11 +138,17 @@ protected:
 	void readImage(int progressiveSizeLimit) const;
 
 	bool checkForOpen();
+	bool openSink();
+	void finishSink(Fn<void()> done);
 	bool tryLoadLocal();
 	void loadLocal(const Storage::Cache::Key &key);
 	virtual Storage::Cache::Key cacheKey() const = 0;
 	virtual std::optional<MediaKey> fileLocationKey() const = 0;
 	virtual void cancelHook() = 0;
+	virtual void stopAutoLoadingHook() {
+	}
+	virtual void refreshAutoLoadingHook(int addedSize) {
+	}
 	virtual void startLoading() = 0;
 	virtual void startLoadingWithPartial(const QByteArray &data) {
 		startLoading();
@@ -157,12 +167,12 @@ protected:
 	bool _autoLoading = false;
 	uint8 _cacheTag = 0;
 	bool _finished = false;
+	bool _finishing = false;
 	bool _cancelled = false;
 	mutable LocalStatus _localStatus = LocalStatus::NotTried;
 
 	QString _filename;
-	QFile _file;
-	bool _fileIsOpen = false;
+	std::unique_ptr<Storage::FileDownloadSink> _sink;
 
 	LoadToCacheSetting _toCache;
 	LoadFromCloudSetting _fromCloud;
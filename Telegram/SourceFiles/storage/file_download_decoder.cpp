@@ -0,0 +1,116 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_download_decoder.h"
+
+#include "app.h"
+
+#include <QtCore/QThread>
+
+namespace Storage {
+namespace {
+
+constexpr auto kMaxRunningDecodes = 4;
+constexpr auto kLogQueueDepth = 64;
+
+struct DecodeQueue {
+	QMutex mutex;
+	std::vector<DecodeTask> visible;
+	std::vector<DecodeTask> background;
+	int running = 0;
+	int64 decoded = 0;
+	int64 skipped = 0;
+};
+
+DecodeQueue Queue;
+
+[[nodiscard]] int MaxRunningDecodes() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount() / 2,
+		1,
+		kMaxRunningDecodes);
+	return result;
+}
+
+[[nodiscard]] std::optional<DecodeTask> PopTask() {
+	QMutexLocker lock(&Queue.mutex);
+	while (true) {
+		auto &list = !Queue.visible.empty()
+			? Queue.visible
+			: Queue.background;
+		if (list.empty()) {
+			if (!--Queue.running) {
+				DEBUG_LOG(("Decode Queue: Done, %1 decoded, %2 skipped."
+					).arg(Queue.decoded
+					).arg(Queue.skipped));
+			}
+			return std::nullopt;
+		}
+		auto result = std::move(list.back());
+		list.pop_back();
+		if (result.guard.alive()) {
+			return result;
+		}
+		++Queue.skipped;
+	}
+}
+
+void Decode(DecodeTask &&task) {
+	auto format = QByteArray();
+	auto image = App::readImage(task.data, &format, false);
+	if (image.isNull()) {
+		format = QByteArray();
+	}
+	task.done(
+		std::move(task.data),
+		std::move(image),
+		std::move(format),
+		std::move(task.guard));
+}
+
+void RunDecodes() {
+	while (auto task = PopTask()) {
+		Decode(std::move(*task));
+
+		QMutexLocker lock(&Queue.mutex);
+		++Queue.decoded;
+	}
+}
+
+} // namespace
+
+void DecodeCachedImage(DecodeTask &&task) {
+	Expects(task.done != nullptr);
+
+	auto launch = false;
+	{
+		QMutexLocker lock(&Queue.mutex);
+		auto &list = (task.priority == DecodePriority::Visible)
+			? Queue.visible
+			: Queue.background;
+		list.push_back(std::move(task));
+		if (Queue.running < MaxRunningDecodes()) {
+			++Queue.running;
+			launch = true;
+		}
+		const auto depth = int(Queue.visible.size() + Queue.background.size());
+		if (depth > 0 && !(depth % kLogQueueDepth)) {
+			DEBUG_LOG(("Decode Queue: "
+				"%1 visible, %2 background, %3 running, %4 decoded, %5 skipped."
+				).arg(Queue.visible.size()
+				).arg(Queue.background.size()
+				).arg(Queue.running
+				).arg(Queue.decoded
+				).arg(Queue.skipped));
+		}
+	}
+	if (launch) {
+		crl::async(RunDecodes);
+	}
+}
+
+} // namespace Storage
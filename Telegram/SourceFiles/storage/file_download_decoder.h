@@ -0,0 +1,42 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/binary_guard.h"
+
+namespace Storage {
+
+enum class DecodePriority {
+	Background,
+	Visible,
+};
+
+struct DecodeTask {
+	QByteArray data;
+	DecodePriority priority = DecodePriority::Visible;
+
+	// The task is dropped without decoding if the guard is dead.
+	base::binary_guard guard;
+
+	// Called from a decoding thread.
+	FnMut<void(
+		QByteArray &&data,
+		QImage &&image,
+		QByteArray &&format,
+		base::binary_guard &&guard)> done;
+};
+
+// Decodes cached images using a limited number of threads.
+//
+// Visible tasks go before background ones, inside one priority
+// the latest requested tasks go first, so that the items that are
+// shown right now after scrolling are decoded before the old ones.
+// The queue state is written to the debug log.
+void DecodeCachedImage(DecodeTask &&task);
+
+} // namespace Storage
@@ -106,6 +106,7 @@ uint64 mtpFileLoader::objId() const {
 
 bool mtpFileLoader::readyToRequest() const {
 	return !_finished
+		&& !_finishing
 		&& !_lastComplete
 		&& (_fullSize != 0 || !haveSentRequests())
 		&& (!_fullSize || _nextRequestOffset < _loadSize);
@@ -158,7 +159,14 @@ bool mtpFileLoader::setWebFileSizeHook(int size) {
 }
 
 void mtpFileLoader::startLoading() {
-	addToQueue();
+	if (_autoLoading) {
+		const auto left = _loadSize
+			? std::max(_loadSize - _nextRequestOffset, 0)
+			: Storage::kDownloadPartSize;
+		addToAutoLoadingQueue(left);
+	} else {
+		addToQueue();
+	}
 }
 
 void mtpFileLoader::startLoadingWithPartial(const QByteArray &data) {
@@ -178,6 +186,14 @@ void mtpFileLoader::cancelHook() {
 	cancelAllRequests();
 }
 
+void mtpFileLoader::stopAutoLoadingHook() {
+	prioritizeInQueue();
+}
+
+void mtpFileLoader::refreshAutoLoadingHook(int addedSize) {
+	refreshInAutoLoadingQueue(addedSize);
+}
+
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
 	return v::match(location().data, [&](const WebFileLocation &location) {
 		return Data::WebDocumentCacheKey(location);
@@ -53,6 +53,8 @@ private:
 	void startLoading() override;
 	void startLoadingWithPartial(const QByteArray &data) override;
 	void cancelHook() override;
+	void stopAutoLoadingHook() override;
+	void refreshAutoLoadingHook(int addedSize) override;
 
 	bool readyToRequest() const override;
 	int takeNextRequestOffset() override;
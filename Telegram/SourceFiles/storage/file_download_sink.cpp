@@ -0,0 +1,283 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_download_sink.h"
+
+#include "storage/download_manager_mtproto.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+namespace Storage {
+namespace {
+
+constexpr auto kFreeBuffersLimit = 8;
+
+// Paths of removed sinks, their files are closed and removed in the
+// background. A new sink for the same path waits until that is done.
+QMutex RemovingMutex;
+QWaitCondition RemovingFinished;
+base::flat_set<QString> RemovingPaths;
+
+void WaitForRemoving(const QString &path) {
+	QMutexLocker lock(&RemovingMutex);
+	while (RemovingPaths.contains(path)) {
+		RemovingFinished.wait(&RemovingMutex);
+	}
+}
+
+} // namespace
+
+struct FileDownloadSink::Shared {
+	base::weak_ptr<FileDownloadSink> weak;
+
+	// Locked while writing a part, always before the queueMutex.
+	// Never locked on the main thread.
+	QMutex fileMutex;
+	QFile file;
+	std::atomic<bool> failed = false;
+
+	// The front part stays in the queue until it is written.
+	QMutex queueMutex;
+	std::deque<Part> queue;
+	std::vector<QByteArray> free;
+	bool scheduled = false;
+};
+
+FileDownloadSink::FileDownloadSink(const QString &path, Fn<void()> failed)
+: _shared(std::make_shared<Shared>())
+, _failed(std::move(failed)) {
+	_shared->weak = base::make_weak(this);
+	_shared->file.setFileName(path);
+}
+
+FileDownloadSink::~FileDownloadSink() = default;
+
+bool FileDownloadSink::open(int64 preallocate) {
+	// The writer thread is not started yet, nothing to wait for here.
+	auto &file = _shared->file;
+	WaitForRemoving(file.fileName());
+
+	// Unbuffered, so that a written part is visible to read() right away.
+	const auto mode = QIODevice::ReadWrite
+		| QIODevice::Truncate
+		| QIODevice::Unbuffered;
+	if (!file.open(mode)) {
+		return false;
+	}
+	// Only sets the file size, the disk space is not reserved and the
+	// file may stay sparse. It is truncated to the written size later.
+	if (preallocate > 0 && !file.resize(preallocate)) {
+		LOG(("Download Error: Could not preallocate %1 bytes in '%2'."
+			).arg(preallocate
+			).arg(file.fileName()));
+	}
+	return true;
+}
+
+void FileDownloadSink::write(int64 offset, bytes::const_span buffer) {
+	if (buffer.empty()) {
+		return;
+	}
+	auto bytes = [&] {
+		QMutexLocker lock(&_shared->queueMutex);
+		auto &free = _shared->free;
+		if (free.empty()) {
+			auto result = QByteArray();
+			result.reserve(kDownloadPartSize);
+			return result;
+		}
+		auto result = std::move(free.back());
+		free.pop_back();
+		return result;
+	}();
+	bytes.append(
+		reinterpret_cast<const char*>(buffer.data()),
+		buffer.size());
+	write(offset, std::move(bytes));
+}
+
+void FileDownloadSink::write(int64 offset, QByteArray &&bytes) {
+	if (bytes.isEmpty()) {
+		return;
+	}
+	accumulate_max(_size, offset + bytes.size());
+	enqueue({ offset, std::move(bytes) });
+}
+
+void FileDownloadSink::enqueue(Part &&part) {
+	const auto schedule = [&] {
+		QMutexLocker lock(&_shared->queueMutex);
+		_shared->queue.push_back(std::move(part));
+		return !std::exchange(_shared->scheduled, true);
+	}();
+	if (schedule) {
+		crl::async([shared = _shared] {
+			WriteQueued(shared);
+		});
+	}
+}
+
+void FileDownloadSink::WriteQueued(const std::shared_ptr<Shared> &shared) {
+	while (true) {
+		while (WriteFront(shared)) {
+		}
+		QMutexLocker lock(&shared->queueMutex);
+		if (shared->queue.empty()) {
+			shared->scheduled = false;
+			return;
+		}
+	}
+}
+
+bool FileDownloadSink::WriteFront(const std::shared_ptr<Shared> &shared) {
+	QMutexLocker fileLock(&shared->fileMutex);
+	const auto part = [&]() -> const Part* {
+		QMutexLocker lock(&shared->queueMutex);
+		// References to deque elements survive push_back().
+		return shared->queue.empty() ? nullptr : &shared->queue.front();
+	}();
+	if (!part) {
+		return false;
+	}
+	WritePart(shared, *part);
+	auto bytes = [&] {
+		QMutexLocker lock(&shared->queueMutex);
+		auto result = std::move(shared->queue.front().bytes);
+		shared->queue.pop_front();
+		return result;
+	}();
+	ReleaseBuffer(shared, std::move(bytes));
+	return true;
+}
+
+void FileDownloadSink::WritePart(
+		const std::shared_ptr<Shared> &shared,
+		const Part &part) {
+	auto &file = shared->file;
+	if (shared->failed || !file.isOpen()) {
+		return;
+	}
+	const auto size = qint64(part.bytes.size());
+	if (!file.seek(part.offset) || file.write(part.bytes) != size) {
+		shared->failed = true;
+		LOG(("Download Error: Could not write %1 bytes to '%2'."
+			).arg(size
+			).arg(file.fileName()));
+		const auto weak = shared->weak;
+		crl::on_main(weak, [=] {
+			if (const auto onstack = weak.get()->_failed) {
+				onstack();
+			}
+		});
+	}
+}
+
+void FileDownloadSink::ReleaseBuffer(
+		const std::shared_ptr<Shared> &shared,
+		QByteArray &&buffer) {
+	if (buffer.capacity() < kDownloadPartSize) {
+		return;
+	}
+	buffer.resize(0);
+
+	QMutexLocker lock(&shared->queueMutex);
+	if (shared->free.size() < kFreeBuffersLimit) {
+		shared->free.push_back(std::move(buffer));
+	}
+}
+
+QByteArray FileDownloadSink::read(int64 offset, int size) {
+	if (_shared->failed || offset + size > _size) {
+		return QByteArray();
+	}
+
+	// Take the queued parts first: a part that leaves the queue after
+	// this is already in the file when we read it below.
+	auto overlay = std::vector<Part>();
+	{
+		QMutexLocker lock(&_shared->queueMutex);
+		for (const auto &part : _shared->queue) {
+			const auto from = std::max(offset, part.offset);
+			const auto till = std::min(
+				offset + size,
+				part.offset + int64(part.bytes.size()));
+			if (from < till) {
+				overlay.push_back({
+					from,
+					part.bytes.mid(from - part.offset, till - from),
+				});
+			}
+		}
+	}
+
+	// A separate handle, so that we don't wait for the writer.
+	auto result = QByteArray();
+	auto file = QFile(_shared->file.fileName());
+	if (!file.open(QIODevice::ReadOnly)
+		|| !file.seek(offset)
+		|| (result = file.read(size)).size() != size) {
+		return QByteArray();
+	}
+
+	// The queued parts are newer than the file contents.
+	for (const auto &part : overlay) {
+		memcpy(
+			result.data() + (part.offset - offset),
+			part.bytes.constData(),
+			part.bytes.size());
+	}
+	return result;
+}
+
+void FileDownloadSink::finish(Fn<void(bool)> done) {
+	crl::async([shared = _shared, size = _size, done = std::move(done)] {
+		while (WriteFront(shared)) {
+		}
+
+		QMutexLocker lock(&shared->fileMutex);
+		auto &file = shared->file;
+		if (!shared->failed && file.isOpen() && file.size() != size) {
+			shared->failed = !file.resize(size);
+		}
+		file.close();
+
+		const auto weak = shared->weak;
+		crl::on_main(weak, [=, result = !shared->failed] {
+			done(result);
+		});
+	});
+}
+
+void FileDownloadSink::remove() {
+	_shared->failed = true;
+	{
+		QMutexLocker lock(&_shared->queueMutex);
+		// The front part may be being written right now.
+		while (_shared->queue.size() > 1) {
+			_shared->queue.pop_back();
+		}
+	}
+	const auto path = _shared->file.fileName();
+	{
+		QMutexLocker lock(&RemovingMutex);
+		RemovingPaths.emplace(path);
+	}
+	crl::async([shared = _shared, path] {
+		{
+			QMutexLocker lock(&shared->fileMutex);
+			shared->file.close();
+			shared->file.remove();
+		}
+		QMutexLocker lock(&RemovingMutex);
+		RemovingPaths.remove(path);
+		RemovingFinished.wakeAll();
+	});
+}
+
+} // namespace Storage
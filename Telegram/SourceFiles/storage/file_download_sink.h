@@ -0,0 +1,63 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/bytes.h"
+#include "base/weak_ptr.h"
+
+namespace Storage {
+
+// Writes downloaded parts to a file in a background thread.
+//
+// Parts are written in the order they were added, part buffers are
+// reused. The main thread never takes the file lock: reading back uses
+// a separate handle plus the parts that were not written yet, removing
+// closes and deletes the file in the background. The failed and the
+// finish callbacks are called on the main thread.
+class FileDownloadSink final : public base::has_weak_ptr {
+public:
+	FileDownloadSink(const QString &path, Fn<void()> failed);
+	~FileDownloadSink();
+
+	[[nodiscard]] bool open(int64 preallocate);
+	void write(int64 offset, bytes::const_span buffer);
+	void write(int64 offset, QByteArray &&bytes);
+	[[nodiscard]] QByteArray read(int64 offset, int size);
+	void finish(Fn<void(bool)> done);
+	void remove();
+
+	// End of the data written so far.
+	[[nodiscard]] int64 size() const {
+		return _size;
+	}
+
+private:
+	struct Part {
+		int64 offset = 0;
+		QByteArray bytes;
+	};
+	struct Shared;
+
+	static void WriteQueued(const std::shared_ptr<Shared> &shared);
+	static bool WriteFront(const std::shared_ptr<Shared> &shared);
+	static void WritePart(
+		const std::shared_ptr<Shared> &shared,
+		const Part &part);
+	static void ReleaseBuffer(
+		const std::shared_ptr<Shared> &shared,
+		QByteArray &&buffer);
+
+	void enqueue(Part &&part);
+
+	const std::shared_ptr<Shared> _shared;
+	const Fn<void()> _failed;
+	int64 _size = 0;
+
+};
+
+} // namespace Storage
@@ -560,7 +560,17 @@ void Uploader::sendNext() {
 		} else {
 			const auto offset = uploadingData.docSentParts
 				* uploadingData.docPartSize;
-			toSend = content.mid(offset, uploadingData.docPartSize);
+			const auto length = std::clamp(
+				int(content.size()) - offset,
+				0,
+				uploadingData.docPartSize);
+
+			// The request is serialized in send(), content outlives it.
+			if (length > 0) {
+				toSend = QByteArray::fromRawData(
+					content.constData() + offset,
+					length);
+			}
 			if ((uploadingData.type() == SendMediaType::File
 				|| uploadingData.type() == SendMediaType::ThemeFile
 				|| uploadingData.type() == SendMediaType::Audio)
@@ -43,6 +43,24 @@ constexpr auto kPhotoUploadPartSize = 32 * 1024;
 
 using Ui::ValidateThumbDimensions;
 
+// Parts point inside the bytes, the caller should hold them.
+[[nodiscard]] UploadFileParts SliceUploadParts(
+		const QByteArray &bytes,
+		QByteArray &md5) {
+	auto result = UploadFileParts();
+	auto hash = HashMd5();
+	const auto size = int(bytes.size());
+	for (auto i = 0, part = 0; i < size; i += kPhotoUploadPartSize, ++part) {
+		const auto data = bytes.constData() + i;
+		const auto length = std::min(size - i, kPhotoUploadPartSize);
+		result.insert(part, QByteArray::fromRawData(data, length));
+		hash.feed(data, length);
+	}
+	md5.resize(32);
+	hashMd5Hex(hash.result(), md5.data());
+	return result;
+}
+
 struct PreparedFileThumbnail {
 	uint64 id = 0;
 	QString name;
@@ -178,14 +196,10 @@ SendMediaReady::SendMediaReady(
 , peer(peer)
 , photo(photo)
 , document(document)
-, photoThumbs(photoThumbs) {
+, photoThumbs(photoThumbs)
+, jpeg(jpeg) {
 	if (!jpeg.isEmpty()) {
-		int32 size = jpeg.size();
-		for (int32 i = 0, part = 0; i < size; i += kPhotoUploadPartSize, ++part) {
-			parts.insert(part, jpeg.mid(i, kPhotoUploadPartSize));
-		}
-		jpeg_md5.resize(32);
-		hashMd5Hex(jpeg.constData(), jpeg.size(), jpeg_md5.data());
+		parts = SliceUploadParts(this->jpeg, jpeg_md5);
 	}
 }
 
@@ -254,7 +268,8 @@ SendMediaReady PreparePeerPhoto(MTP::DcId dcId, PeerId peerId, QImage &&image) {
 		0);
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int workersCount)
+: _workersCount(std::max(workersCount, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -265,17 +280,21 @@ TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
 
 TaskId TaskQueue::addTask(std::unique_ptr<Task> &&task) {
 	const auto result = task->id();
+	_finishOrder.push_back(result);
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		_tasksToProcess.push_back(std::move(task));
 	}
 
-	wakeThread();
+	wakeThreads(1);
 
 	return result;
 }
 
 void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
+	for (const auto &task : tasks) {
+		_finishOrder.push_back(task->id());
+	}
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		for (auto &task : tasks) {
@@ -283,78 +302,104 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 		}
 	}
 
-	wakeThread();
+	wakeThreads(int(tasks.size()));
 }
 
-void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
+void TaskQueue::wakeThreads(int tasksAdded) {
+	const auto wanted = std::min(
+		int(_workers.size()) + tasksAdded,
+		_workersCount);
+	while (int(_workers.size()) < wanted) {
+		auto &entry = _workers.emplace_back();
+		entry.thread = new QThread();
 
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
+		entry.worker = new TaskQueueWorker(this);
+		entry.worker->moveToThread(entry.thread);
 
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+		connect(this, SIGNAL(taskAdded()), entry.worker, SLOT(onTaskAdded()));
+		connect(entry.worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
 
-		_thread->start();
+		entry.thread->start();
 	}
 	if (_stopTimer) _stopTimer->stop();
 	taskAdded();
 }
 
 void TaskQueue::cancelTask(TaskId id) {
-	const auto removeFrom = [&](std::deque<std::unique_ptr<Task>> &queue) {
-		const auto proj = [](const std::unique_ptr<Task> &task) {
-			return task->id();
-		};
+	const auto proj = [](const std::unique_ptr<Task> &task) {
+		return task->id();
+	};
+	const auto removeFrom = [&](auto &queue) {
 		auto i = ranges::find(queue, id, proj);
 		if (i != queue.end()) {
 			queue.erase(i);
 		}
 	};
+	_finishOrder.erase(
+		ranges::remove(_finishOrder, id),
+		end(_finishOrder));
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
-		}
+		_tasksInProcess.erase(
+			ranges::remove(_tasksInProcess, id),
+			end(_tasksInProcess));
+	}
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		removeFrom(_tasksToFinish);
 	}
-	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+
+	// Later tasks could be waiting for this one to finish.
+	crl::on_main(this, [=] {
+		onTaskProcessed();
+	});
 }
 
 void TaskQueue::onTaskProcessed() {
-	do {
+	while (!_finishOrder.empty()) {
 		auto task = std::unique_ptr<Task>();
 		{
 			QMutexLocker lock(&_tasksToFinishMutex);
-			if (_tasksToFinish.empty()) break;
-			task = std::move(_tasksToFinish.front());
-			_tasksToFinish.pop_front();
+			const auto i = ranges::find(
+				_tasksToFinish,
+				_finishOrder.front(),
+				&Task::id);
+			if (i == end(_tasksToFinish)) {
+				break;
+			}
+			task = std::move(*i);
+			_tasksToFinish.erase(i);
 		}
+		_finishOrder.pop_front();
 		task->finish();
-	} while (true);
+	}
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcess.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	for (const auto &entry : _workers) {
+		entry.thread->requestInterruption();
+		entry.thread->quit();
+	}
+	if (!_workers.empty()) {
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	}
+	for (auto &entry : base::take(_workers)) {
+		entry.thread->wait();
+		delete entry.worker;
+		delete entry.thread;
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksInProcess.clear();
+	_finishOrder.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -374,7 +419,7 @@ void TaskQueueWorker::onTaskAdded() {
 			if (!_queue->_tasksToProcess.empty()) {
 				task = std::move(_queue->_tasksToProcess.front());
 				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+				_queue->_tasksInProcess.push_back(task->id());
 			}
 		}
 
@@ -383,13 +428,17 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
+				auto &inProcess = _queue->_tasksInProcess;
+				const auto i = ranges::find(inProcess, task->id());
+				someTasksLeft = !_queue->_tasksToProcess.empty();
+				if (i != end(inProcess)) {
+					inProcess.erase(i);
+
+					// Even if some tasks are already waiting in
+					// _tasksToFinish they may wait for this one.
 					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
 					_queue->_tasksToFinish.push_back(std::move(task));
+					emitTaskProcessed = true;
 				}
 			}
 			if (emitTaskProcessed) {
@@ -465,23 +514,15 @@ void FileLoadResult::setFileData(const QByteArray &filedata) {
 		partssize = 0;
 	} else {
 		partssize = filedata.size();
-		for (int32 i = 0, part = 0; i < partssize; i += kPhotoUploadPartSize, ++part) {
-			fileparts.insert(part, filedata.mid(i, kPhotoUploadPartSize));
-		}
-		filemd5.resize(32);
-		hashMd5Hex(filedata.constData(), filedata.size(), filemd5.data());
+		filebytes = filedata;
+		fileparts = SliceUploadParts(filebytes, filemd5);
 	}
 }
 
 void FileLoadResult::setThumbData(const QByteArray &thumbdata) {
 	if (!thumbdata.isEmpty()) {
 		thumbbytes = thumbdata;
-		int32 size = thumbdata.size();
-		for (int32 i = 0, part = 0; i < size; i += kPhotoUploadPartSize, ++part) {
-			thumbparts.insert(part, thumbdata.mid(i, kPhotoUploadPartSize));
-		}
-		thumbmd5.resize(32);
-		hashMd5Hex(thumbdata.constData(), thumbdata.size(), thumbmd5.data());
+		thumbparts = SliceUploadParts(thumbbytes, thumbmd5);
 	}
 }
 
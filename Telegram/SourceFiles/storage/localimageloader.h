@@ -108,7 +108,8 @@ struct SendMediaReady {
 	MTPPhoto photo;
 	MTPDocument document;
 	PreparedPhotoThumbs photoThumbs;
-	UploadFileParts parts;
+	QByteArray jpeg;
+	UploadFileParts parts; // Point inside jpeg.
 	QByteArray jpeg_md5;
 
 	QString caption;
@@ -131,12 +132,16 @@ public:
 
 };
 
+// Tasks are processed by up to workersCount threads in parallel,
+// but finish() is called for them in the order they were added.
 class TaskQueueWorker;
 class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	explicit TaskQueue(
+		crl::time stopTimeoutMs = 0, // <= 0 - never stop workers
+		int workersCount = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -154,14 +159,20 @@ public Q_SLOTS:
 private:
 	friend class TaskQueueWorker;
 
-	void wakeThread();
+	struct Worker {
+		QThread *thread = nullptr;
+		TaskQueueWorker *worker = nullptr;
+	};
+
+	void wakeThreads(int tasksAdded);
 
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
-	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	std::vector<std::unique_ptr<Task>> _tasksToFinish;
+	std::vector<TaskId> _tasksInProcess;
+	std::deque<TaskId> _finishOrder; // Accessed from the main thread only.
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	std::vector<Worker> _workers;
+	int _workersCount = 1;
 	QTimer *_stopTimer = nullptr;
 
 };
@@ -247,13 +258,14 @@ struct FileLoadResult {
 	QString filename;
 	QString filemime;
 	int32 filesize = 0;
-	UploadFileParts fileparts;
+	QByteArray filebytes;
+	UploadFileParts fileparts; // Point inside filebytes.
 	QByteArray filemd5;
 	int32 partssize;
 
 	uint64 thumbId = 0; // id is always file-id of media, thumbId is file-id of thumb ( == id for photos)
 	QString thumbname;
-	UploadFileParts thumbparts;
+	UploadFileParts thumbparts; // Point inside thumbbytes.
 	QByteArray thumbbytes;
 	QByteArray thumbmd5;
 	QImage thumb;
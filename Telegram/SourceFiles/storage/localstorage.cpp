@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/details/storage_file_utilities.h"
 #include "storage/details/storage_settings_scheme.h"
+#include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
@@ -821,12 +822,27 @@ int32 oldSettingsVersion() {
 	return _oldSettingsVersion;
 }
 
+[[nodiscard]] bool IsCountingWaveform(
+		not_null<VoiceData*> voice,
+		TaskId taskId) {
+	if (voice->waveform.size() <= int(sizeof(TaskId))
+		|| voice->waveform[0] != -1) {
+		return false;
+	}
+	auto counting = TaskId();
+	memcpy(&counting, voice->waveform.constData() + 1, sizeof(counting));
+	return (counting == taskId);
+}
+
 class CountWaveformTask : public Task {
 public:
-	CountWaveformTask(not_null<Data::DocumentMedia*> media)
-	: _doc(media->owner())
+	CountWaveformTask(
+		not_null<DocumentData*> document,
+		const QByteArray &bytes)
+	: _doc(document)
+	, _session(base::make_weak(&document->session()))
 	, _loc(_doc->location(true))
-	, _data(media->bytes())
+	, _data(bytes)
 	, _wavemax(0) {
 		if (_data.isEmpty() && !_loc.accessEnable()) {
 			_doc = nullptr;
@@ -835,16 +851,37 @@ public:
 	void process() override {
 		if (!_doc) return;
 
-		_waveform = audioCountWaveform(_loc, _data);
+		const auto document = not_null<DocumentData*>(_doc);
+		const auto taskId = id();
+		const auto partial = [=, session = _session](
+				VoiceWaveform &&waveform) {
+			crl::on_main(session, [=, waveform = std::move(waveform)] {
+				const auto voice = document->voice();
+				if (!voice || !IsCountingWaveform(voice, taskId)) {
+					return;
+				}
+				voice->partialWaveform = waveform;
+				voice->partialWavemax = *ranges::max_element(waveform);
+				document->owner().requestDocumentViewRepaint(document);
+			});
+		};
+		_waveform = audioCountWaveform(_loc, _data, partial);
 		_wavemax = _waveform.empty()
 			? char(0)
 			: *ranges::max_element(_waveform);
 	}
 	void finish() override {
 		if (const auto voice = _doc ? _doc->voice() : nullptr) {
+			voice->partialWaveform = VoiceWaveform();
+			voice->partialWavemax = 0;
 			if (!_waveform.isEmpty()) {
 				voice->waveform = _waveform;
 				voice->wavemax = _wavemax;
+				_doc->owner().cache().put(
+					_doc->waveformCacheKey(),
+					Storage::Cache::Database::TaggedValue(
+						documentWaveformEncode5bit(_waveform),
+						Data::kVoiceMessageCacheTag));
 			}
 			if (voice->waveform.isEmpty()) {
 				voice->waveform.resize(1);
@@ -865,6 +902,7 @@ public:
 
 protected:
 	DocumentData *_doc = nullptr;
+	base::weak_ptr<Main::Session> _session;
 	Core::FileLocation _loc;
 	QByteArray _data;
 	VoiceWaveform _waveform;
@@ -874,15 +912,41 @@ protected:
 
 void countVoiceWaveform(not_null<Data::DocumentMedia*> media) {
 	const auto document = media->owner();
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(media));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
 	}
+	voice->waveform.resize(1);
+	voice->waveform[0] = -1; // counting
+
+	// Waveforms counted before are taken from the cache,
+	// only the files seen for the first time are decoded.
+	const auto bytes = media->bytes();
+	const auto guard = base::make_weak(&document->session());
+	const auto got = [=](QByteArray value) {
+		crl::on_main(guard, [=] {
+			const auto voice = document->voice();
+			if (!voice
+				|| voice->waveform.size() != 1
+				|| voice->waveform[0] != -1) {
+				return;
+			}
+			auto cached = documentWaveformDecode(value);
+			if (!cached.isEmpty()) {
+				voice->waveform = std::move(cached);
+				voice->wavemax = *ranges::max_element(voice->waveform);
+				document->owner().requestDocumentViewRepaint(document);
+			} else if (_localLoader) {
+				voice->waveform.resize(1 + sizeof(TaskId));
+				const auto taskId = _localLoader->addTask(
+					std::make_unique<CountWaveformTask>(document, bytes));
+				memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+			} else {
+				voice->waveform[0] = -2;
+			}
+		});
+	};
+	document->owner().cache().get(document->waveformCacheKey(), got);
 }
 
 void cancelTask(TaskId id) {
@@ -326,20 +326,30 @@ PeerData *readPeer(
 }
 
 QString peekUserPhone(int streamAppVersion, QDataStream &stream) {
+	const auto result = peekUser(streamAppVersion, stream);
+	return result ? result->phone : QString();
+}
+
+std::optional<PeekedUser> peekUser(
+		int streamAppVersion,
+		QDataStream &stream) {
 	quint64 peerId = 0, photoId = 0;
 	stream >> peerId >> photoId;
-	DEBUG_LOG(("peekUserPhone.id: %1").arg(peerId));
+	DEBUG_LOG(("peekUser.id: %1").arg(peerId));
 	if (!peerId
 		|| !peerIsUser(peerId)
 		|| !readStorageImageLocation(streamAppVersion, stream)) {
-		return QString();
+		return std::nullopt;
 	}
 
-	QString first, last, phone;
-	stream >> first >> last >> phone;
-	DEBUG_LOG(("peekUserPhone.data: %1 %2 %3"
-		).arg(first, last, phone));
-	return phone;
+	auto result = PeekedUser();
+	stream >> result.firstName >> result.lastName >> result.phone;
+	DEBUG_LOG(("peekUser.data: %1 %2 %3"
+		).arg(result.firstName, result.lastName, result.phone));
+	if (stream.status() != QDataStream::Ok) {
+		return std::nullopt;
+	}
+	return result;
 }
 
 } // namespace Serialize
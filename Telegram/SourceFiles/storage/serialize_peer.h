@@ -37,4 +37,13 @@ PeerData *readPeer(
 	QDataStream &stream);
 QString peekUserPhone(int streamAppVersion, QDataStream &stream);
 
+struct PeekedUser {
+	QString firstName;
+	QString lastName;
+	QString phone;
+};
+std::optional<PeekedUser> peekUser(
+	int streamAppVersion,
+	QDataStream &stream);
+
 } // namespace Serialize
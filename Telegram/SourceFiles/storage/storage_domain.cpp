@@ -171,6 +171,12 @@ Domain::StartModernResult Domain::startModern(
 
 	_oldVersion = keyData.version;
 
+	struct Prepared {
+		int index = 0;
+		std::unique_ptr<Main::Account> account;
+		std::unique_ptr<MTP::Config> config;
+	};
+	auto prepared = std::vector<Prepared>();
 	auto tried = base::flat_set<int>();
 	auto sessions = base::flat_set<uint64>();
 	auto active = 0;
@@ -192,10 +198,10 @@ Domain::StartModernResult Domain::startModern(
 				if (sessions.empty()) {
 					active = index;
 				}
-				account->start(std::move(config));
-				_owner->accountAddedInStorage({
+				prepared.push_back({
 					.index = index,
-					.account = std::move(account)
+					.account = std::move(account),
+					.config = std::move(config),
 				});
 				sessions.emplace(sessionId);
 			}
@@ -209,6 +215,19 @@ Domain::StartModernResult Domain::startModern(
 	if (!info.stream.atEnd()) {
 		info.stream >> active;
 	}
+	if (!ranges::contains(prepared, active, &Prepared::index)) {
+		active = prepared.front().index;
+	}
+
+	// Only the active account creates its session right away.
+	for (auto &[index, account, config] : prepared) {
+		account->setDormant(index != active);
+		account->start(std::move(config));
+		_owner->accountAddedInStorage({
+			.index = index,
+			.account = std::move(account)
+		});
+	}
 	_owner->activateFromStorage(active);
 
 	Ensures(!sessions.empty());
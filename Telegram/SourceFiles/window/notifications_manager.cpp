@@ -598,10 +598,9 @@ QString Manager::addTargetAccountName(
 		not_null<Main::Session*> session) {
 	const auto add = [&] {
 		for (const auto &[index, account] : Core::App().domain().accounts()) {
-			if (const auto other = account->maybeSession()) {
-				if (other != session) {
-					return true;
-				}
+			if (account.get() != &session->account()
+				&& account->authorized()) {
+				return true;
 			}
 		}
 		return false;
@@ -44,6 +44,7 @@ constexpr auto kThemeFileSizeLimit = 5 * 1024 * 1024;
 constexpr auto kBackgroundSizeLimit = 25 * 1024 * 1024;
 constexpr auto kNightThemeFile = ":/gui/night.tdesktop-theme"_cs;
 constexpr auto kMinimumTiledSize = 512;
+constexpr auto kPreparedBackgroundsLimit = 2;
 
 struct Applying {
 	Saved data;
@@ -51,9 +52,17 @@ struct Applying {
 	Fn<void()> overrideKeep;
 };
 
+struct PreparedBackground {
+	QByteArray cached;
+	QImage image;
+};
+
 NeverFreedPointer<ChatBackground> GlobalBackground;
 Applying GlobalApplying;
 
+// Last decoded cached backgrounds, day and night ones usually.
+std::deque<PreparedBackground> GlobalPreparedBackgrounds;
+
 inline bool AreTestingTheme() {
 	return !GlobalApplying.paletteForRevert.isEmpty();
 }
@@ -266,6 +275,40 @@ bool loadBackground(zlib::FileToRead &file, QByteArray *outBackground, bool *out
 	return true;
 }
 
+void RememberPreparedBackground(
+		const QByteArray &cached,
+		const QImage &image) {
+	if (GlobalPreparedBackgrounds.size() == kPreparedBackgroundsLimit) {
+		GlobalPreparedBackgrounds.pop_front();
+	}
+	GlobalPreparedBackgrounds.push_back({ cached, image });
+}
+
+QImage ReadCachedBackground(const QByteArray &cached) {
+	if (cached.isEmpty()) {
+		return QImage();
+	}
+	const auto i = ranges::find(
+		GlobalPreparedBackgrounds,
+		cached,
+		&PreparedBackground::cached);
+	if (i != end(GlobalPreparedBackgrounds)) {
+		return i->image;
+	}
+
+	QImage background;
+	QDataStream stream(cached);
+	QImageReader reader(stream.device());
+#ifndef OS_MAC_OLD
+	reader.setAutoTransform(true);
+#endif // OS_MAC_OLD
+	if (!reader.read(&background) || background.isNull()) {
+		return QImage();
+	}
+	RememberPreparedBackground(cached, background);
+	return background;
+}
+
 bool LoadTheme(
 		const QByteArray &content,
 		const Colorizer &colorizer,
@@ -337,6 +380,7 @@ bool LoadTheme(
 					return false;
 				}
 				cache->tiled = backgroundTiled;
+				RememberPreparedBackground(cache->background, background);
 			}
 			applyBackground(std::move(background), backgroundTiled, out);
 		}
@@ -364,26 +408,26 @@ bool LoadTheme(
 	return true;
 }
 
-bool InitializeFromCache(
-		const QByteArray &content,
-		const Cached &cache) {
+bool CacheValid(const QByteArray &content, const Cached &cache) {
 	if (cache.paletteChecksum != style::palette::Checksum()) {
 		return false;
 	}
 	if (cache.contentChecksum != base::crc32(content.constData(), content.size())) {
 		return false;
 	}
+	return true;
+}
 
-	QImage background;
-	if (!cache.background.isEmpty()) {
-		QDataStream stream(cache.background);
-		QImageReader reader(stream.device());
-#ifndef OS_MAC_OLD
-		reader.setAutoTransform(true);
-#endif // OS_MAC_OLD
-		if (!reader.read(&background) || background.isNull()) {
-			return false;
-		}
+bool InitializeFromCache(
+		const QByteArray &content,
+		const Cached &cache) {
+	if (!CacheValid(content, cache)) {
+		return false;
+	}
+
+	auto background = ReadCachedBackground(cache.background);
+	if (!cache.background.isEmpty() && background.isNull()) {
+		return false;
 	}
 
 	if (!style::main_palette::load(cache.colors)) {
@@ -397,6 +441,32 @@ bool InitializeFromCache(
 	return true;
 }
 
+// Fills the instance from the cache, without unpacking and parsing
+// the theme content or decoding the background image again.
+bool LoadThemeFromCache(
+		const QByteArray &content,
+		const Cached &cache,
+		not_null<Instance*> out) {
+	if (!CacheValid(content, cache)) {
+		return false;
+	}
+
+	auto background = ReadCachedBackground(cache.background);
+	if (!cache.background.isEmpty() && background.isNull()) {
+		return false;
+	}
+
+	if (!out->palette.load(cache.colors)) {
+		return false;
+	}
+	out->cached = cache;
+	if (!background.isNull()) {
+		applyBackground(std::move(background), cache.tiled, out);
+	}
+
+	return true;
+}
+
 [[nodiscard]] std::optional<QByteArray> ReadEditingPalette() {
 	auto file = QFile(EditingPalettePath());
 	return file.open(QIODevice::ReadOnly)
@@ -1105,13 +1175,16 @@ void ChatBackground::reapplyWithNightMode(
 		}
 		auto preview = std::make_unique<Preview>();
 		preview->object = std::move(read.object);
-		preview->instance.cached = std::move(read.cache);
-		const auto loaded = LoadTheme(
+		const auto loaded = LoadThemeFromCache(
 			preview->object.content,
-			ColorizerForTheme(path),
-			std::nullopt,
-			&preview->instance.cached,
-			&preview->instance);
+			read.cache,
+			&preview->instance)
+			|| LoadTheme(
+				preview->object.content,
+				ColorizerForTheme(path),
+				std::nullopt,
+				&preview->instance.cached,
+				&preview->instance);
 		if (!loaded) {
 			return false;
 		}
@@ -1184,6 +1257,7 @@ bool Initialize(Saved &&saved) {
 void Uninitialize() {
 	GlobalBackground.clear();
 	GlobalApplying = Applying();
+	GlobalPreparedBackgrounds.clear();
 }
 
 bool Apply(
@@ -21,6 +21,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/wrap/slide_wrap.h"
 #include "ui/wrap/vertical_layout.h"
 #include "ui/text/text_utilities.h"
+#include "ui/text/text_options.h"
 #include "ui/special_buttons.h"
 #include "ui/empty_userpic.h"
 #include "dialogs/dialogs_layout.h"
@@ -148,8 +149,15 @@ private:
 	void paintEvent(QPaintEvent *e) override;
 	void contextMenuEvent(QContextMenuEvent *e) override;
 	void paintUserpic(Painter &p);
+	[[nodiscard]] const Ui::Text::String &nameText() const;
+
+	const not_null<Main::Account*> _account;
+
+	// Null for dormant accounts, they are painted from the stored data.
+	Main::Session * const _session = nullptr;
+	std::optional<Ui::EmptyUserpic> _dormantUserpic;
+	Ui::Text::String _dormantName;
 
-	const not_null<Main::Session*> _session;
 	const style::Menu &_st;
 	std::shared_ptr<Data::CloudImageView> _userpicView;
 	InMemoryKey _userpicKey = {};
@@ -202,7 +210,8 @@ MainMenu::AccountButton::AccountButton(
 	QWidget *parent,
 	not_null<Main::Account*> account)
 : RippleButton(parent, st::defaultRippleAnimation)
-, _session(&account->session())
+, _account(account)
+, _session(account->maybeSession())
 , _st(st::mainMenu){
 	const auto height = _st.itemPadding.top()
 		+ _st.itemStyle.font->height
@@ -216,6 +225,25 @@ MainMenu::AccountButton::AccountButton(
 		}
 	});
 
+	if (!_session) {
+		// Don't create a session only to show the name and the counter.
+		Assert(account->dormant());
+
+		const auto name = account->authorizedName();
+		_dormantUserpic.emplace(
+			Data::PeerUserpicColor(peerFromUser(account->authorizedUserId())),
+			name);
+		_dormantName.setText(st::msgNameStyle, name, Ui::NameTextOptions());
+
+		account->dormantUnreadCountChanges(
+		) | rpl::start_with_next([=](int count) {
+			_unreadBadge = count;
+			update();
+		}, lifetime());
+		_unreadBadge = account->dormantUnreadCount();
+		_unreadBadgeMuted = false;
+		return;
+	}
 	rpl::single(
 		rpl::empty_value()
 	) | rpl::then(
@@ -227,6 +255,10 @@ MainMenu::AccountButton::AccountButton(
 	}, lifetime());
 }
 
+const Ui::Text::String &MainMenu::AccountButton::nameText() const {
+	return _session ? _session->user()->nameText() : _dormantName;
+}
+
 void MainMenu::AccountButton::paintUserpic(Painter &p) {
 	const auto size = st::mainMenuAccountSize;
 	const auto iconSize = height() - 2 * _st.itemIconPosition.y();
@@ -234,8 +266,12 @@ void MainMenu::AccountButton::paintUserpic(Painter &p) {
 	const auto x = _st.itemIconPosition.x() - shift;
 	const auto y = (height() - size) / 2;
 
-	const auto check = (&_session->account()
-		== &Core::App().domain().active());
+	if (!_session) {
+		// Dormant accounts are never active, so no check is painted.
+		_dormantUserpic->paint(p, x, y, width(), size);
+		return;
+	}
+	const auto check = (_account == &Core::App().domain().active());
 	const auto user = _session->user();
 	if (!check) {
 		user->paintUserpicLeft(p, _userpicView, x, y, width(), size);
@@ -286,7 +322,7 @@ void MainMenu::AccountButton::paintEvent(QPaintEvent *e) {
 
 	auto available = width() - _st.itemPadding.left();
 	if (_unreadBadge
-		&& (&_session->account() != &Core::App().activeAccount())) {
+		&& (_account != &Core::App().activeAccount())) {
 		_unreadSt.muted = _unreadBadgeMuted;
 		const auto string = (_unreadBadge > 99)
 			? "99+"
@@ -309,7 +345,7 @@ void MainMenu::AccountButton::paintEvent(QPaintEvent *e) {
 	}
 
 	p.setPen(over ? _st.itemFgOver : _st.itemFg);
-	_session->user()->nameText().drawElided(
+	nameText().drawElided(
 		p,
 		_st.itemPadding.left(),
 		_st.itemPadding.top(),
@@ -317,7 +353,7 @@ void MainMenu::AccountButton::paintEvent(QPaintEvent *e) {
 }
 
 void MainMenu::AccountButton::contextMenuEvent(QContextMenuEvent *e) {
-	if (!_menu && IsAltShift(e->modifiers())) {
+	if (!_menu && _session && IsAltShift(e->modifiers())) {
 		_menu = base::make_unique_q<Ui::PopupMenu>(this);
 		const auto addAction = [&](const QString &text, Fn<void()> callback) {
 			return _menu->addAction(
@@ -328,24 +364,24 @@ void MainMenu::AccountButton::contextMenuEvent(QContextMenuEvent *e) {
 		_menu->popup(QCursor::pos());
 		return;
 	}
-	if (&_session->account() == &Core::App().activeAccount() || _menu) {
+	if (_account == &Core::App().activeAccount() || _menu) {
 		return;
 	}
 	_menu = base::make_unique_q<Ui::PopupMenu>(this);
 	_menu->addAction(tr::lng_menu_activate(tr::now), crl::guard(this, [=] {
-		Core::App().domain().activate(&_session->account());
+		Core::App().domain().activate(_account);
 	}));
 	_menu->addAction(tr::lng_settings_logout(tr::now), crl::guard(this, [=] {
-		const auto session = _session;
+		const auto account = _account;
 		const auto callback = [=](Fn<void()> &&close) {
 			close();
-			Core::App().logout(&session->account());
+			Core::App().logout(account);
 		};
 		Ui::show(Box<ConfirmBox>(
 			tr::lng_sure_logout(tr::now),
 			tr::lng_settings_logout(tr::now),
 			st::attentionBoxButton,
-			crl::guard(session, callback)));
+			crl::guard(account, callback)));
 	}));
 	_menu->popup(QCursor::pos());
 }
@@ -762,10 +798,22 @@ void MainMenu::setupAccounts() {
 			}
 		}
 		for (const auto &[index, account] : list) {
-			if (_watched.emplace(account.get()).second) {
-				account->sessionChanges(
-				) | rpl::start_with_next([=](Main::Session *session) {
-					rebuildAccounts();
+			const auto raw = account.get();
+			if (_watched.emplace(raw).second) {
+				rpl::merge(
+					raw->sessionChanges() | rpl::to_empty,
+					raw->dormantChanges() | rpl::to_empty
+				) | rpl::start_with_next([=] {
+					// The button paints either the session or the stored
+					// dormant data, so it is recreated when they change.
+					// Not right away, it may be activating from its menu.
+					crl::on_main(this, [=] {
+						const auto i = _watched.find(raw);
+						if (i != _watched.end()) {
+							i->second = nullptr;
+							rebuildAccounts();
+						}
+					});
 				}, lifetime());
 			}
 		}
@@ -788,7 +836,7 @@ void MainMenu::rebuildAccounts() {
 		Assert(i != _watched.end());
 
 		auto &button = i->second;
-		if (!account->sessionExists()) {
+		if (!account->authorized()) {
 			button = nullptr;
 		} else if (!button) {
 			button.reset(inner->insert(
@@ -1205,6 +1253,10 @@ OthersUnreadState OtherAccountsUnreadStateCurrent() {
 				allMuted = false;
 				break;
 			}
+		} else if (account->dormantUnreadCount() > 0) {
+			// Dormant accounts have no muted state, as in Domain.
+			allMuted = false;
+			break;
 		}
 	}
 	return {
@@ -29,6 +29,8 @@ PRIVATE
     export/output/export_output_json.cpp
     export/output/export_output_json.h
     export/output/export_output_result.h
+    export/output/export_output_state.cpp
+    export/output/export_output_state.h
     export/output/export_output_stats.cpp
     export/output/export_output_stats.h
 )